@@ -2,6 +2,7 @@
 #include <iostream>
 #include <unistd.h>   // For read()
 #include <termios.h>  // For terminal control
+#include <sys/select.h> // For select()
 
 // Constructor: Configure terminal for non-canonical mode
 // Saves the original terminal settings and disables canonical mode and echo for real-time input reading.
@@ -125,3 +126,17 @@ std::string AnsiTerminal::getInputWithEditing() {
 
     return input;
 }
+
+// Method to wait for a keystroke with a timeout
+// Lets the caller refresh the screen while background work is running without blocking on read().
+bool AnsiTerminal::waitForInput(int timeoutMs) {
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    FD_SET(STDIN_FILENO, &readSet);
+
+    struct timeval timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+
+    return select(STDIN_FILENO + 1, &readSet, nullptr, nullptr, &timeout) > 0;
+}
@@ -33,6 +33,9 @@ public:
     // Capture user input with backspace support (for editing inputs)
     std::string getInputWithEditing();
 
+    // Wait up to timeoutMs milliseconds for a keystroke; returns true if one is ready to read
+    bool waitForInput(int timeoutMs);
+
 private:
     struct termios original_tio; // Holds the original terminal settings
 };
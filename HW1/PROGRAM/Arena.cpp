@@ -0,0 +1,50 @@
+#include "Arena.h"
+#include <new>
+
+Arena::Arena(size_t blockSize)
+    : blockSize(blockSize), current(nullptr), remaining(0), freeLists(maxSmallSize / alignment + 1, nullptr) {}
+
+Arena::~Arena() {
+    for (char* block : blocks) {
+        ::operator delete(block);
+    }
+}
+
+void* Arena::allocate(size_t bytes) {
+    if (bytes > maxSmallSize) {
+        return ::operator new(bytes);
+    }
+
+    // Round up to a whole number of aligned units, then reuse a freed chunk of that size if there is one
+    size_t sizeClass = (bytes + alignment - 1) / alignment;
+    if (sizeClass == 0) sizeClass = 1;
+    if (FreeChunk* chunk = freeLists[sizeClass]) {
+        freeLists[sizeClass] = chunk->next;
+        return chunk;
+    }
+
+    // Otherwise carve the chunk from the newest block, starting a new block when it is used up
+    size_t size = sizeClass * alignment;
+    if (size > remaining) {
+        current = static_cast<char*>(::operator new(blockSize));
+        blocks.push_back(current);
+        remaining = blockSize;
+    }
+    void* pointer = current;
+    current += size;
+    remaining -= size;
+    return pointer;
+}
+
+void Arena::deallocate(void* pointer, size_t bytes) {
+    if (bytes > maxSmallSize) {
+        ::operator delete(pointer);
+        return;
+    }
+
+    size_t sizeClass = (bytes + alignment - 1) / alignment;
+    if (sizeClass == 0) sizeClass = 1;
+    FreeChunk* chunk = static_cast<FreeChunk*>(pointer);
+    chunk->next = freeLists[sizeClass];
+    freeLists[sizeClass] = chunk;
+}
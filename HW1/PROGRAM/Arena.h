@@ -0,0 +1,60 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+// Block allocator for many small, short-lived objects (dependency graph nodes). Memory is carved
+// from large blocks; freed chunks go on a free list for their size and are reused by later
+// allocations, so rebuilding a graph after a clear or reload does not go back to malloc.
+// All blocks are returned together when the arena is destroyed. Not thread-safe: an arena
+// belongs to one spreadsheet or workbook.
+class Arena {
+public:
+    explicit Arena(size_t blockSize = 64 * 1024); // Creates an empty arena that grows in blocks of blockSize bytes
+    ~Arena(); // Releases every block at once
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t bytes); // Returns memory for an object of the given size
+    void deallocate(void* pointer, size_t bytes); // Gives memory back for reuse by objects of the same size
+    size_t bytesReserved() const { return blocks.size() * blockSize; } // Returns the memory held in blocks
+
+private:
+    static const size_t alignment = alignof(std::max_align_t); // Every chunk is aligned for any type
+    static const size_t maxSmallSize = 512; // Larger requests (e.g., hash table bucket arrays) use operator new
+
+    // Header placed in a freed chunk to link it into its free list
+    struct FreeChunk {
+        FreeChunk* next;
+    };
+
+    size_t blockSize; // Size of each block in bytes
+    std::vector<char*> blocks; // All blocks allocated so far
+    char* current; // Next unused byte in the newest block
+    size_t remaining; // Unused bytes left in the newest block
+    std::vector<FreeChunk*> freeLists; // Free chunks by size class (bytes / alignment)
+};
+
+// Standard allocator that takes its memory from an Arena, for use with standard containers
+template <typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    explicit ArenaAllocator(Arena& arena) : arena(&arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T))); }
+    void deallocate(T* pointer, size_t n) { arena->deallocate(pointer, n * sizeof(T)); }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+
+    Arena* arena; // Arena the memory comes from (shared by every container built from this allocator)
+};
+
+#endif // ARENA_H
@@ -0,0 +1,34 @@
+#include "AutoSaver.h"
+#include <memory>
+
+AutoSaver::AutoSaver(int intervalSeconds)
+    : fileManager(false), interval(intervalSeconds), dirty(false), lastSave(std::chrono::steady_clock::now()) {}
+
+void AutoSaver::save(const std::string& filename, const SheetData& data) {
+    dirty = false;
+    lastSave = std::chrono::steady_clock::now();
+
+    // The snapshot is taken now, so later edits cannot change what gets written
+    auto snapshot = std::make_shared<SheetData>(data);
+    worker.submit([this, filename, snapshot]() {
+        bool saved = fileManager.saveToFile(filename, *snapshot);
+        std::lock_guard<std::mutex> lock(statusMutex);
+        status = saved ? "Spreadsheet saved to " + filename : "Failed to save file: " + filename;
+    });
+}
+
+bool AutoSaver::autosaveDue() const {
+    return dirty && std::chrono::steady_clock::now() - lastSave >= interval;
+}
+
+void AutoSaver::autosave(const std::string& filename, const SheetData& data) {
+    save(filename + ".autosave", data);
+}
+
+std::string AutoSaver::takeStatus() {
+    std::string failure = worker.takeFailure();
+    std::lock_guard<std::mutex> lock(statusMutex);
+    std::string message;
+    message.swap(status);
+    return failure.empty() ? message : failure;
+}
@@ -0,0 +1,37 @@
+#ifndef AUTOSAVER_H
+#define AUTOSAVER_H
+
+#include "BackgroundWorker.h"
+#include "FileManager.h"
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Writes spreadsheet snapshots to disk on a worker thread so the UI never waits for file I/O,
+// and decides when unsaved edits are due for an automatic backup save
+class AutoSaver {
+public:
+    explicit AutoSaver(int intervalSeconds = 30); // Autosaves at most once per interval
+
+    // Queues a save of the snapshot; the status message is available from takeStatus() when done
+    void save(const std::string& filename, const SheetData& data);
+
+    void markDirty() { dirty = true; } // Records an edit that has not been saved yet
+    bool autosaveDue() const; // Checks if there are unsaved edits and the interval has passed
+    void autosave(const std::string& filename, const SheetData& data); // Saves a backup to <filename>.autosave
+
+    bool isBusy() const { return worker.isBusy(); } // Checks if a save is running or queued
+    std::string takeStatus(); // Returns and clears the message of the last finished save
+
+private:
+    FileManager fileManager; // Used only on the worker thread (quiet: failures go to the status)
+    std::chrono::seconds interval; // Minimum time between autosaves
+    bool dirty; // Whether there are edits since the last save
+    std::chrono::steady_clock::time_point lastSave; // Time of the last save or autosave
+    std::mutex statusMutex; // Guards status
+    std::string status; // Message of the last finished save
+    BackgroundWorker worker; // Worker thread (declared last so it stops before the other members are destroyed)
+};
+
+#endif // AUTOSAVER_H
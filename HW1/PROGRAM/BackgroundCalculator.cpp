@@ -0,0 +1,160 @@
+#include "BackgroundCalculator.h"
+#include <memory>
+
+BackgroundCalculator::BackgroundCalculator() : pendingCells(0), catchUpQueued(false) {
+    viewport.firstCol = 0;
+    viewport.colCount = 0;
+    model.setLazyEvaluation(true); // Loaded formulas are evaluated on screen first, then in catch-up chunks
+
+    // Every value the model evaluates becomes part of the running command's batch
+    model.setValueListener([this](const std::string& sheetName, int row, int col, double value) {
+        CellResult result;
+        result.sheetName = sheetName;
+        result.row = row;
+        result.col = col;
+        result.value = value;
+        pendingBatch.push_back(result);
+    });
+
+    // Errors are shown by the UI with the batch, since the worker must not write over the screen
+    model.setErrorListener([this](const std::string& message) { pendingErrors.push_back(message); });
+}
+
+void BackgroundCalculator::run(std::function<void(Workbook&)> command) {
+    worker.submit([this, command]() {
+        std::lock_guard<std::mutex> modelLock(modelMutex);
+        try {
+            command(model);
+        } catch (const std::exception& e) {
+            pendingErrors.push_back(std::string("Error: ") + e.what());
+        }
+
+        // Publish the whole batch at once so the UI never sees half of a recalculation
+        {
+            std::lock_guard<std::mutex> resultsLock(resultsMutex);
+            finishedResults.insert(finishedResults.end(), pendingBatch.begin(), pendingBatch.end());
+            finishedErrors.insert(finishedErrors.end(), pendingErrors.begin(), pendingErrors.end());
+            pendingBatch.clear();
+            pendingErrors.clear();
+        }
+
+        // Keep evaluating what a lazy load left pending, one chunk after another
+        pendingCells = model.getPendingCount();
+        if (pendingCells > 0) scheduleCatchUp();
+    });
+}
+
+void BackgroundCalculator::scheduleCatchUp() {
+    // Nobody will see the values once the worker is shutting down
+    if (worker.isStopping() || catchUpQueued.exchange(true)) return;
+
+    run([this](Workbook& wb) {
+        catchUpQueued = false;
+        if (worker.isStopping()) return; // Queued before shutdown: skip it, but still drain the edits behind it
+
+        // The cells on screen come first
+        Viewport shown;
+        {
+            std::lock_guard<std::mutex> lock(viewportMutex);
+            shown = viewport;
+        }
+        if (wb.hasSheet(shown.sheetName)) {
+            wb.getSheet(shown.sheetName).evaluateVisible(shown.gridRows, shown.firstCol, shown.colCount);
+        }
+
+        wb.evaluatePending(catchUpChunk);
+    });
+}
+
+void BackgroundCalculator::addSheet(const std::string& name, int rows, int cols) {
+    run([name, rows, cols](Workbook& wb) { wb.addSheet(name, rows, cols); });
+}
+
+void BackgroundCalculator::resizeSheet(const std::string& name, int rows, int cols) {
+    run([name, rows, cols](Workbook& wb) { wb.getSheet(name).resizeGrid(rows, cols); });
+}
+
+void BackgroundCalculator::defineName(const std::string& name, const std::string& reference, const std::string& defaultSheet) {
+    run([name, reference, defaultSheet](Workbook& wb) { wb.defineName(name, reference, defaultSheet); });
+}
+
+void BackgroundCalculator::setCell(const std::string& sheetName, int row, int col, const std::string& value) {
+    run([sheetName, row, col, value](Workbook& wb) { wb.setCell(sheetName, row, col, value); });
+}
+
+void BackgroundCalculator::loadSheetData(const std::string& sheetName, const SheetData& data) {
+    auto snapshot = std::make_shared<SheetData>(data); // Shared so the copy is made only once
+    run([sheetName, snapshot](Workbook& wb) { wb.loadSheetData(sheetName, *snapshot); });
+}
+
+void BackgroundCalculator::clearSheet(const std::string& sheetName) {
+    run([sheetName](Workbook& wb) { wb.clearSheet(sheetName); });
+}
+
+void BackgroundCalculator::setViewport(const std::string& sheetName, const std::vector<int>& gridRows, int firstCol, int colCount) {
+    {
+        std::lock_guard<std::mutex> lock(viewportMutex);
+        viewport.sheetName = sheetName;
+        viewport.gridRows = gridRows;
+        viewport.firstCol = firstCol;
+        viewport.colCount = colCount;
+    }
+
+    // Make sure the new area is evaluated soon, even if no other command is coming
+    if (pendingCells > 0) scheduleCatchUp();
+}
+
+bool BackgroundCalculator::applyResults(Workbook& display) {
+    std::vector<CellResult> results;
+    {
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        results.swap(finishedResults);
+    }
+
+    for (const auto& result : results) {
+        display.applyValue(result.sheetName, result.row, result.col, result.value);
+    }
+    return !results.empty();
+}
+
+std::vector<std::string> BackgroundCalculator::takeErrors() {
+    std::vector<std::string> errors;
+    {
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        errors.swap(finishedErrors);
+    }
+
+    std::string failure = worker.takeFailure();
+    if (!failure.empty()) errors.push_back(failure);
+    return errors;
+}
+
+void BackgroundCalculator::setProfiling(bool on) {
+    std::lock_guard<std::mutex> lock(modelMutex);
+    model.getProfiler().setEnabled(on);
+}
+
+bool BackgroundCalculator::isProfiling() {
+    std::lock_guard<std::mutex> lock(modelMutex);
+    return model.getProfiler().isEnabled();
+}
+
+void BackgroundCalculator::resetProfile() {
+    std::lock_guard<std::mutex> lock(modelMutex);
+    model.getProfiler().reset();
+}
+
+void BackgroundCalculator::printProfile(std::ostream& out, RecalcProfiler::SortKey sortKey, size_t limit) {
+    std::lock_guard<std::mutex> lock(modelMutex);
+    model.printProfile(out, sortKey, limit);
+}
+
+bool BackgroundCalculator::startTrace(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(modelMutex);
+    return model.getTrace().open(filename);
+}
+
+void BackgroundCalculator::stopTrace() {
+    std::lock_guard<std::mutex> lock(modelMutex);
+    model.getTrace().close();
+}
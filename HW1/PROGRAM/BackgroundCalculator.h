@@ -0,0 +1,83 @@
+#ifndef BACKGROUNDCALCULATOR_H
+#define BACKGROUNDCALCULATOR_H
+
+#include "BackgroundWorker.h"
+#include "Workbook.h"
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Recalculates formulas on a worker thread so the terminal UI never waits for them.
+// The calculator keeps its own copy of the workbook and replays every edit on it in order.
+// After each edit it publishes the new formula values as one batch, so the UI (which
+// applies whole batches) always shows a consistent, possibly slightly stale, state.
+// Loaded files are evaluated lazily: the cells on screen first, then the rest in small
+// catch-up chunks queued behind the edits, so a large file shows its visible values quickly.
+// On shutdown the queued edits still run, but pending catch-up work is dropped.
+class BackgroundCalculator {
+public:
+    BackgroundCalculator(); // Creates the calculation model with the same default sheet as a new Workbook
+
+    // Edits to replay on the calculation model (same meaning as the Workbook methods)
+    void addSheet(const std::string& name, int rows, int cols);
+    void resizeSheet(const std::string& name, int rows, int cols);
+    void defineName(const std::string& name, const std::string& reference, const std::string& defaultSheet);
+    void setCell(const std::string& sheetName, int row, int col, const std::string& value);
+    void loadSheetData(const std::string& sheetName, const SheetData& data);
+    void clearSheet(const std::string& sheetName);
+
+    // Area of the screen whose pending formulas are evaluated before any others
+    void setViewport(const std::string& sheetName, const std::vector<int>& gridRows, int firstCol, int colCount);
+
+    bool applyResults(Workbook& display); // Copies finished values into the displayed workbook; returns true if any arrived
+    std::vector<std::string> takeErrors(); // Returns and clears the error messages of finished commands
+    bool isBusy() const { return worker.isBusy(); } // Checks if a recalculation is running or queued
+    void waitUntilIdle() { worker.waitUntilIdle(); } // Blocks until every queued edit has been recalculated
+
+    // Profiling of the calculation model (these wait for the running recalculation to finish)
+    void setProfiling(bool on);
+    bool isProfiling();
+    void resetProfile();
+    void printProfile(std::ostream& out, RecalcProfiler::SortKey sortKey, size_t limit = 10);
+
+    // Evaluation trace of the calculation model (see RecalcTrace)
+    bool startTrace(const std::string& filename);
+    void stopTrace();
+
+private:
+    // A formula value computed by the worker
+    struct CellResult {
+        std::string sheetName;
+        int row, col;
+        double value;
+    };
+
+    // Screen area last reported by the UI
+    struct Viewport {
+        std::string sheetName;
+        std::vector<int> gridRows;
+        int firstCol, colCount;
+    };
+
+    void run(std::function<void(Workbook&)> command); // Queues a command for the calculation model
+    void scheduleCatchUp(); // Queues one chunk of pending formula evaluation, unless one is already queued
+
+    static const size_t catchUpChunk = 2000; // Pending cells evaluated per catch-up command
+
+    Workbook model; // Calculation model; only used by the worker thread or under modelMutex
+    std::mutex modelMutex; // Guards the model
+    std::vector<CellResult> pendingBatch; // Values computed by the running command (worker thread only)
+    std::vector<std::string> pendingErrors; // Errors of the running command (worker thread only)
+    std::mutex resultsMutex; // Guards finishedResults and finishedErrors
+    std::vector<CellResult> finishedResults; // Values of finished commands waiting for the UI
+    std::vector<std::string> finishedErrors; // Errors of finished commands waiting for the UI (the worker never prints)
+    std::mutex viewportMutex; // Guards viewport
+    Viewport viewport; // Cells the UI is showing
+    std::atomic<size_t> pendingCells; // Formulas the model has not evaluated yet (as of the last command)
+    std::atomic<bool> catchUpQueued; // Whether a catch-up chunk is waiting to run
+    BackgroundWorker worker; // Worker thread (declared last so it stops before the other members are destroyed)
+};
+
+#endif // BACKGROUNDCALCULATOR_H
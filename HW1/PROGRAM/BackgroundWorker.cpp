@@ -0,0 +1,69 @@
+#include "BackgroundWorker.h"
+#include <exception>
+
+BackgroundWorker::BackgroundWorker() : jobRunning(false), stopping(false), thread(&BackgroundWorker::run, this) {}
+
+BackgroundWorker::~BackgroundWorker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_one();
+    thread.join();
+}
+
+void BackgroundWorker::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    wakeUp.notify_one();
+}
+
+bool BackgroundWorker::isBusy() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return jobRunning || !jobs.empty();
+}
+
+bool BackgroundWorker::isStopping() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stopping;
+}
+
+void BackgroundWorker::waitUntilIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this]() { return !jobRunning && jobs.empty(); });
+}
+
+std::string BackgroundWorker::takeFailure() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string message;
+    message.swap(failure);
+    return message;
+}
+
+void BackgroundWorker::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wakeUp.wait(lock, [this]() { return stopping || !jobs.empty(); });
+        if (jobs.empty()) break; // Stopping and nothing left to do
+
+        std::function<void()> job = std::move(jobs.front());
+        jobs.pop_front();
+        jobRunning = true;
+
+        // Run the job without holding the lock so new jobs can be queued meanwhile
+        lock.unlock();
+        std::string jobFailure;
+        try {
+            job();
+        } catch (const std::exception& e) {
+            jobFailure = std::string("Background job failed: ") + e.what();
+        }
+        lock.lock();
+        if (!jobFailure.empty()) failure = jobFailure;
+
+        jobRunning = false;
+        if (jobs.empty()) idle.notify_all();
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef BACKGROUNDWORKER_H
+#define BACKGROUNDWORKER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Runs queued jobs one at a time, in submission order, on a single background thread
+class BackgroundWorker {
+public:
+    BackgroundWorker(); // Starts the worker thread
+    ~BackgroundWorker(); // Finishes the queued jobs and stops the thread
+
+    BackgroundWorker(const BackgroundWorker&) = delete;
+    BackgroundWorker& operator=(const BackgroundWorker&) = delete;
+
+    void submit(std::function<void()> job); // Queues a job to run on the worker thread
+    bool isBusy() const; // Checks if a job is running or waiting to run
+    bool isStopping() const; // Checks if the destructor is draining the queue before stopping
+    void waitUntilIdle(); // Blocks until every queued job has finished
+    std::string takeFailure(); // Returns and clears the message of the last job that threw (empty if none)
+
+private:
+    void run(); // Main loop of the worker thread
+
+    mutable std::mutex mutex; // Guards the job queue and flags
+    std::condition_variable wakeUp; // Signals the worker that a job arrived or it must stop
+    std::condition_variable idle; // Signals waiters that the queue has drained
+    std::deque<std::function<void()>> jobs; // Jobs waiting to run
+    bool jobRunning; // Whether a job is currently executing
+    bool stopping; // Whether the destructor asked the thread to stop
+    std::string failure; // Message of the last job that threw (reported by the owner, never printed here)
+    std::thread thread; // Worker thread (declared last so it starts after the other members exist)
+};
+
+#endif // BACKGROUNDWORKER_H
@@ -1,37 +1,52 @@
 #include "Cell.h"
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
 
 // Constructor: Initializes a cell with default values
-Cell::Cell() : value(""), numericValue(0), isFormula(false) {}
+Cell::Cell() : numericValue(0), isFormula(false), isNumber(false), isPending(false), isCalculating(false) {}
 
-void Cell::setValue(const std::string& val) {
+void Cell::setValue(const InternedString& val) {
     value = val;
-    isFormula = (!val.empty() && val[0] == '='); // Check if the value is a formula (starts with '=')
+    isPending = false; // New content replaces any value still waiting to be computed
+    isCalculating = false;
+    isFormula = (!val.empty() && val.str()[0] == '='); // Check if the value is a formula (starts with '=')
 
     // If the value is not a formula, attempt to convert it to a numeric value
-    if (!isFormula) {
-        try {
-            numericValue = std::stod(val); // Convert to a double if possible
-        } catch (...) {
-            numericValue = 0; // Set to zero if conversion fails
-        }
-    } else {
-        numericValue = 0; // For formulas, the calculation is done in the Spreadsheet class
+    isNumber = !isFormula && parseNumber(val.str(), numericValue);
+    if (!isNumber) {
+        numericValue = 0; // Labels are zero; formulas are calculated in the Spreadsheet class
     }
 }
 
 std::string Cell::getDisplayValue() const {
     // If the cell contains a formula, return numericValue as a string for display purposes
-    return isFormula ? std::to_string(numericValue) : value;
+    if (isFormula && isCalculating) return "..."; // Its new value has not arrived yet
+    return isFormula ? std::to_string(numericValue) : value.str();
 }
 
 std::string Cell::getType() const {
     if (isFormula) return "F"; // "F" for Formula
 
-    // Check if the value is numeric, including negative numbers
-    try {
-        std::stod(value); // Attempt to convert the value to a number
-        return "V"; // "V" for Value (numeric)
-    } catch (...) {
-        return "L"; // "L" for Label (non-numeric text)
+    return isNumber ? "V" : "L"; // "V" for Value (numeric), "L" for Label (non-numeric text)
+}
+
+bool Cell::parseNumber(const std::string& text, double& number) {
+    // Most labels are rejected by their first character, before calling strtod
+    // (a number may start with a sign, a digit, a dot, or "inf"/"nan" like std::stod accepts)
+    size_t start = 0;
+    while (start < text.size() && std::isspace(static_cast<unsigned char>(text[start]))) ++start;
+    if (start == text.size()) return false;
+    char first = static_cast<char>(std::tolower(static_cast<unsigned char>(text[start])));
+    if (!std::isdigit(static_cast<unsigned char>(first)) && first != '-' && first != '+' && first != '.' && first != 'i' && first != 'n') {
+        return false;
     }
+
+    const char* begin = text.c_str();
+    char* end;
+    errno = 0;
+    double parsed = std::strtod(begin, &end);
+    if (end == begin || errno == ERANGE) return false; // std::stod would have thrown here
+    number = parsed;
+    return true;
 }
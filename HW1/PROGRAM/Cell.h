@@ -1,26 +1,34 @@
 #ifndef CELL_H
 #define CELL_H
 
+#include "InternedString.h"
 #include <string>
 
 // Represents a single cell in the spreadsheet
 class Cell {
 public:
-    std::string value; // Raw cell value (text or formula)
+    InternedString value; // Raw cell value (text or formula), shared with identical cells
     double numericValue; // Numeric interpretation of the cell's value (if applicable)
     bool isFormula; // Indicates if the cell contains a formula
+    bool isNumber; // Indicates if the value starts with a number (classified once, when the value is set)
+    bool isPending; // Indicates a formula whose value has not been computed yet (lazy evaluation)
+    bool isCalculating; // Indicates a formula whose new value is being computed elsewhere (shown as "...")
 
     // Default constructor: Initializes cell with empty values
     Cell();
 
     // Sets the value of the cell and determines its type
-    void setValue(const std::string& val);
+    void setValue(const InternedString& val);
 
     // Returns the value to display in the spreadsheet
     std::string getDisplayValue() const;
 
     // Determines and returns the type of the cell ("V" for Value, "L" for Label, "F" for Formula)
     std::string getType() const;
+
+    // Parses the number at the start of text (same rule as std::stod) without throwing;
+    // returns false for labels, empty text and out-of-range numbers
+    static bool parseNumber(const std::string& text, double& number);
 };
 
 #endif // CELL_H
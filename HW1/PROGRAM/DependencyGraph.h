@@ -0,0 +1,26 @@
+#ifndef DEPENDENCYGRAPH_H
+#define DEPENDENCYGRAPH_H
+
+#include "Arena.h"
+#include <functional>
+#include <scoped_allocator>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+// Set of cell names whose tree nodes live in an Arena
+typedef std::set<std::string, std::less<std::string>, ArenaAllocator<std::string>> CellSet;
+
+// Cell name -> set of cell names. The scoped allocator hands the map's arena to every CellSet
+// the map creates (e.g., through operator[]), so all graph nodes come from the same arena.
+typedef std::unordered_map<std::string, CellSet, std::hash<std::string>, std::equal_to<std::string>,
+                           std::scoped_allocator_adaptor<ArenaAllocator<std::pair<const std::string, CellSet>>>>
+    DependencyGraph;
+
+// Creates an empty graph that allocates from the given arena
+inline DependencyGraph makeDependencyGraph(Arena& arena) {
+    return DependencyGraph(0, std::hash<std::string>(), std::equal_to<std::string>(),
+                           DependencyGraph::allocator_type(ArenaAllocator<std::pair<const std::string, CellSet>>(arena)));
+}
+
+#endif // DEPENDENCYGRAPH_H
@@ -4,10 +4,10 @@
 #include <iostream>
 
 // Save the spreadsheet to a CSV file
-bool FileManager::saveToFile(const std::string& filename, const std::vector<std::vector<std::string>>& data) {
+bool FileManager::saveToFile(const std::string& filename, const SheetData& data) {
     std::ofstream file(filename);
     if (!file.is_open()) {
-        std::cerr << "Error: Could not open file " << filename << " for writing." << std::endl;
+        if (reportErrors) std::cerr << "Error: Could not open file " << filename << " for writing." << std::endl;
         return false;
     }
 
@@ -26,10 +26,10 @@ bool FileManager::saveToFile(const std::string& filename, const std::vector<std:
 }
 
 // Load spreadsheet data from a CSV file
-bool FileManager::loadFromFile(const std::string& filename, std::vector<std::vector<std::string>>& data) {
+bool FileManager::loadFromFile(const std::string& filename, SheetData& data) {
     std::ifstream file(filename);
     if (!file.is_open()) {
-        std::cerr << "Error: Could not open file " << filename << " for reading." << std::endl;
+        if (reportErrors) std::cerr << "Error: Could not open file " << filename << " for reading." << std::endl;
         return false;
     }
 
@@ -39,7 +39,7 @@ bool FileManager::loadFromFile(const std::string& filename, std::vector<std::vec
 
     // Read file line by line
     while (std::getline(file, line)) {
-        std::vector<std::string> row;
+        std::vector<InternedString> row;
         std::istringstream stream(line);
         std::string cell;
 
@@ -67,7 +67,7 @@ bool FileManager::loadFromFile(const std::string& filename, std::vector<std::vec
 bool FileManager::createNewFile(const std::string& filename) {
     std::ofstream file(filename);
     if (!file.is_open()) {
-        std::cerr << "Error: Could not create file " << filename << "." << std::endl;
+        if (reportErrors) std::cerr << "Error: Could not create file " << filename << "." << std::endl;
         return false;
     }
     file.close();
@@ -75,6 +75,6 @@ bool FileManager::createNewFile(const std::string& filename) {
 }
 
 // Save the spreadsheet to a new file
-bool FileManager::saveAs(const std::string& newFilename, const std::vector<std::vector<std::string>>& data) {
+bool FileManager::saveAs(const std::string& newFilename, const SheetData& data) {
     return saveToFile(newFilename, data);
 }
@@ -1,22 +1,29 @@
 #ifndef FILEMANAGER_H
 #define FILEMANAGER_H
 
+#include "InternedString.h"
 #include <string>
 #include <vector>
 
 class FileManager {
 public:
+    // Error messages go to std::cerr unless reportErrors is false (e.g., on a worker thread)
+    explicit FileManager(bool reportErrors = true) : reportErrors(reportErrors) {}
+
     // Saves the spreadsheet to a CSV file
-    bool saveToFile(const std::string& filename, const std::vector<std::vector<std::string>>& data);
+    bool saveToFile(const std::string& filename, const SheetData& data);
 
     // Loads spreadsheet data from a CSV file
-    bool loadFromFile(const std::string& filename, std::vector<std::vector<std::string>>& data);
+    bool loadFromFile(const std::string& filename, SheetData& data);
 
     // Creates a new empty file
     bool createNewFile(const std::string& filename);
 
     // Saves the spreadsheet to a new file
-    bool saveAs(const std::string& newFilename, const std::vector<std::vector<std::string>>& data);
+    bool saveAs(const std::string& newFilename, const SheetData& data);
+
+private:
+    bool reportErrors; // Whether failures are printed to std::cerr
 };
 
 #endif // FILEMANAGER_H
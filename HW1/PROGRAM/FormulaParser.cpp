@@ -1,5 +1,6 @@
 // FormulaParser.cpp
 #include "FormulaParser.h"
+#include "Spreadsheet.h" // For columnName
 #include <sstream>
 #include <stdexcept>
 #include <cctype>
@@ -7,14 +8,31 @@
 #include <algorithm>
 #include <numeric>
 
-// Helper function: Extracts the column letter from a cell reference
-char FormulaParser::getColumnLetter(const std::string& cellRef) {
-    return cellRef[0];
+// Helper function: Converts the column letters of a cell reference to a column index (same base-26 scheme as columnName)
+int FormulaParser::getColumnIndex(const std::string& cellRef) {
+    int col = 0;
+    for (size_t i = 0; i < cellRef.size() && std::isalpha(cellRef[i]); ++i) {
+        col = col * 26 + (std::toupper(cellRef[i]) - 'A' + 1);
+    }
+    return col - 1;
 }
 
-// Helper function: Extracts the row number from a cell reference
+// Helper function: Extracts the row number that follows the column letters of a cell reference
 int FormulaParser::getRowNumber(const std::string& cellRef) {
-    return std::stoi(cellRef.substr(1));
+    size_t i = 0;
+    while (i < cellRef.size() && std::isalpha(cellRef[i])) ++i;
+    return std::stoi(cellRef.substr(i));
+}
+
+// Helper function: Splits an optional sheet prefix (e.g., "Sheet2!") from a cell reference
+std::string FormulaParser::splitSheetPrefix(const std::string& cellRef, std::string& sheetPrefix) {
+    auto bang = cellRef.find('!');
+    if (bang == std::string::npos) {
+        sheetPrefix.clear();
+        return cellRef;
+    }
+    sheetPrefix = cellRef.substr(0, bang + 1); // Keep the '!' so the prefix can be prepended directly
+    return cellRef.substr(bang + 1);
 }
 
 // Adds spaces around mathematical operators in a formula to facilitate parsing
@@ -32,8 +50,21 @@ std::string FormulaParser::addSpacesAroundOperators(const std::string& formula)
     return processed;
 }
 
-// Parses a formula and evaluates it using the provided cell values
+// Looks up a cell value in the map
+bool MapValueProvider::getValue(const std::string& cellRef, double& value) const {
+    auto it = cellValues.find(cellRef);
+    if (it == cellValues.end()) return false;
+    value = it->second;
+    return true;
+}
+
+// Parses a formula and evaluates it using the provided map of cell values
 double FormulaParser::parse(const std::string& formula, const std::unordered_map<std::string, double>& cellValues) {
+    return parse(formula, MapValueProvider(cellValues));
+}
+
+// Parses a formula and evaluates it using the provided cell values
+double FormulaParser::parse(const std::string& formula, const CellValueProvider& cellValues) {
     if (formula.empty() || formula[0] != '=') {
         throw std::invalid_argument("Invalid formula");
     }
@@ -43,7 +74,7 @@ double FormulaParser::parse(const std::string& formula, const std::unordered_map
 }
 
 // Evaluates an expression and computes its value based on the given cell values
-double FormulaParser::evaluateExpression(const std::string& expression, const std::unordered_map<std::string, double>& cellValues) {
+double FormulaParser::evaluateExpression(const std::string& expression, const CellValueProvider& cellValues) {
     std::istringstream stream(expression);
     double result = 0;
     char op = '+'; // Default operator is addition
@@ -84,12 +115,12 @@ double FormulaParser::evaluateExpression(const std::string& expression, const st
 }
 
 // Retrieves the numeric value of a cell based on its reference
-double FormulaParser::getCellValue(const std::string& cellRef, const std::unordered_map<std::string, double>& cellValues) {
-    auto it = cellValues.find(cellRef);
-    if (it == cellValues.end()) {
+double FormulaParser::getCellValue(const std::string& cellRef, const CellValueProvider& cellValues) {
+    double value;
+    if (!cellValues.getValue(cellRef, value)) {
         throw std::runtime_error("Cell reference not found: " + cellRef);
     }
-    return it->second;
+    return value;
 }
 
 // Parses a range (e.g., A1..B2) and returns all the cell references within the range
@@ -101,18 +132,20 @@ std::vector<std::string> FormulaParser::parseRange(const std::string& range) {
         throw std::invalid_argument("Invalid range: " + range);
     }
 
-    std::string startCell = range.substr(0, delimiterPos);
-    std::string endCell = range.substr(delimiterPos + 2);
+    // The sheet prefix of the start cell applies to the whole range (e.g., Sheet2!A1..A5)
+    std::string sheetPrefix, endPrefix;
+    std::string startCell = splitSheetPrefix(range.substr(0, delimiterPos), sheetPrefix);
+    std::string endCell = splitSheetPrefix(range.substr(delimiterPos + 2), endPrefix);
 
-    char startCol = getColumnLetter(startCell);
+    int startCol = getColumnIndex(startCell);
     int startRow = getRowNumber(startCell);
-    char endCol = getColumnLetter(endCell);
+    int endCol = getColumnIndex(endCell);
     int endRow = getRowNumber(endCell);
 
     // Generate all cells in the range
-    for (char col = startCol; col <= endCol; ++col) {
+    for (int col = startCol; col <= endCol; ++col) {
         for (int row = startRow; row <= endRow; ++row) {
-            cells.push_back(std::string(1, col) + std::to_string(row));
+            cells.push_back(sheetPrefix + columnName(col) + std::to_string(row));
         }
     }
 
@@ -122,7 +155,13 @@ std::vector<std::string> FormulaParser::parseRange(const std::string& range) {
 // Evaluates a function (e.g., SUM, AVER, etc.) over a given range
 double FormulaParser::evaluateFunction(const std::string& funcName, 
                                        const std::string& range, 
-                                       const std::unordered_map<std::string, double>& cellValues) {
+                                       const CellValueProvider& cellValues) {
+    // Use the provider's cached aggregates when it has them
+    double aggregated;
+    if (cellValues.aggregate(funcName, range, aggregated)) {
+        return aggregated;
+    }
+
     auto cells = parseRange(range);
     std::vector<double> values;
     values.reserve(cells.size());
@@ -152,7 +191,7 @@ double FormulaParser::evaluateFunction(const std::string& funcName,
     }
 }
 
-// Extracts all cell references from a formula (e.g., A1, B2, etc.)
+// Extracts all cell references from a formula (e.g., A1, B2, Sheet2!C3, etc.)
 std::set<std::string> FormulaParser::extractCellReferences(const std::string& formula) {
     std::set<std::string> references;
 
@@ -161,56 +200,72 @@ std::set<std::string> FormulaParser::extractCellReferences(const std::string& fo
         return references;
     }
 
-    std::string current;
-    bool inFunction = false;
+    // Reads a word of letters, digits and underscores starting at position i
+    auto readWord = [&formula](size_t i) {
+        size_t end = i;
+        while (end < formula.length() && (std::isalnum(formula[end]) || formula[end] == '_')) {
+            ++end;
+        }
+        return formula.substr(i, end - i);
+    };
+
+    // Checks whether a word looks like a cell reference (letters followed by digits)
+    auto isCellName = [](const std::string& word) {
+        size_t i = 0;
+        while (i < word.size() && std::isalpha(word[i])) ++i;
+        if (i == 0 || i == word.size()) return false;
+        while (i < word.size() && std::isdigit(word[i])) ++i;
+        return i == word.size();
+    };
 
     for (size_t i = 1; i < formula.length(); ++i) {
-        char c = formula[i];
+        if (!std::isalpha(formula[i])) continue;
 
-        if (c == '(') {
-            inFunction = true; // Inside a function
-            continue;
-        } else if (c == ')') {
-            inFunction = false; // End of a function
+        std::string word = readWord(i);
+        i += word.size();
+
+        // A word followed by '!' is a sheet name; the cell reference comes after it
+        std::string sheetPrefix;
+        if (i < formula.length() && formula[i] == '!') {
+            sheetPrefix = word + "!";
+            word = readWord(++i);
+            i += word.size();
+        }
+
+        // Function names (SUM, MAX, ...) and other words are not cell references
+        if (!isCellName(word)) {
+            --i;
             continue;
         }
 
-        if (std::isalpha(c)) {
-            current = std::string(1, c);
-            while (i + 1 < formula.length() && std::isdigit(formula[i + 1])) {
-                current += formula[++i];
+        if (i + 1 < formula.length() && formula[i] == '.' && formula[i + 1] == '.') {
+            // Range starting point; find the end of the range (it may repeat the sheet prefix)
+            i += 2;
+            std::string endCell = readWord(i);
+            i += endCell.size();
+            if (i < formula.length() && formula[i] == '!') {
+                endCell = readWord(++i);
+                i += endCell.size();
             }
 
-            if (i + 2 < formula.length() && formula[i + 1] == '.' && formula[i + 2] == '.') {
-                // Range starting point
-                std::string startCell = current;
-                i += 2; // Skip ".."
-
-                // Find the end of the range
-                std::string endCell;
-                if (i + 1 < formula.length() && std::isalpha(formula[i + 1])) {
-                    endCell += formula[++i];
-                    while (i + 1 < formula.length() && std::isdigit(formula[i + 1])) {
-                        endCell += formula[++i];
-                    }
+            if (isCellName(endCell)) {
+                // Add all cells in the range
+                int startCol = getColumnIndex(word);
+                int startRow = getRowNumber(word);
+                int endCol = getColumnIndex(endCell);
+                int endRow = getRowNumber(endCell);
 
-                    // Add all cells in the range
-                    char startCol = getColumnLetter(startCell);
-                    int startRow = getRowNumber(startCell);
-                    char endCol = getColumnLetter(endCell);
-                    int endRow = getRowNumber(endCell);
-
-                    for (char col = startCol; col <= endCol; ++col) {
-                        for (int row = startRow; row <= endRow; ++row) {
-                            references.insert(std::string(1, col) + std::to_string(row));
-                        }
+                for (int col = startCol; col <= endCol; ++col) {
+                    for (int row = startRow; row <= endRow; ++row) {
+                        references.insert(sheetPrefix + columnName(col) + std::to_string(row));
                     }
                 }
-            } else {
-                // Single cell reference
-                references.insert(current);
             }
+        } else {
+            // Single cell reference
+            references.insert(sheetPrefix + word);
         }
+        --i; // The loop increment moves past the last character read
     }
 
     return references;
@@ -6,32 +6,61 @@
 #include <vector>
 #include <set>
 
+// Supplies cell values to the parser, and optionally precomputed range aggregates
+class CellValueProvider {
+public:
+    virtual ~CellValueProvider() {}
+
+    // Looks up the numeric value of a cell reference (e.g., "A1"); returns false if there is no such cell
+    virtual bool getValue(const std::string& cellRef, double& value) const = 0;
+
+    // Computes a function (SUM, AVER, MAX, MIN) over a range without visiting every cell;
+    // returns false when no fast path is available and the parser should visit the cells itself
+    virtual bool aggregate(const std::string& funcName, const std::string& range, double& result) const {
+        (void)funcName; (void)range; (void)result;
+        return false;
+    }
+};
+
+// Provides cell values from a map of cell names to values
+class MapValueProvider : public CellValueProvider {
+public:
+    explicit MapValueProvider(const std::unordered_map<std::string, double>& cellValues) : cellValues(cellValues) {}
+    bool getValue(const std::string& cellRef, double& value) const override;
+private:
+    const std::unordered_map<std::string, double>& cellValues;
+};
+
 class FormulaParser {
 public:
     // Parses a formula string and evaluates its value using the provided cell values
     double parse(const std::string& formula, const std::unordered_map<std::string, double>& cellValues);
+    double parse(const std::string& formula, const CellValueProvider& cellValues);
 
     // Adds spaces around operators (+, -, *, /) in the formula for easier parsing
     std::string addSpacesAroundOperators(const std::string& formula);
 
     // Evaluates an expression (e.g., "A1 + B2") and computes its value using the provided cell values
-    double evaluateExpression(const std::string& expression, const std::unordered_map<std::string, double>& cellValues);
+    double evaluateExpression(const std::string& expression, const CellValueProvider& cellValues);
 
     // Gets the numeric value of a specific cell reference (e.g., "A1") from the provided cell values
-    double getCellValue(const std::string& cellRef, const std::unordered_map<std::string, double>& cellValues);
+    double getCellValue(const std::string& cellRef, const CellValueProvider& cellValues);
 
     // Evaluates a function (e.g., SUM, AVER, MAX) over a range of cells using the provided cell values
-    double evaluateFunction(const std::string& funcName, const std::string& range, const std::unordered_map<std::string, double>& cellValues);
+    double evaluateFunction(const std::string& funcName, const std::string& range, const CellValueProvider& cellValues);
 
     // Extracts all cell references (e.g., A1, B2) from a formula
     std::set<std::string> extractCellReferences(const std::string& formula);
 
-    // Retrieves the column letter from a cell reference (e.g., "A1" -> 'A')
-    char getColumnLetter(const std::string& cellRef);
+    // Retrieves the column index from a cell reference (e.g., "A1" -> 0, "AA1" -> 26)
+    int getColumnIndex(const std::string& cellRef);
 
-    // Retrieves the row number from a cell reference (e.g., "A1" -> 1)
+    // Retrieves the row number from a cell reference (e.g., "A1" -> 1, "AB12" -> 12)
     int getRowNumber(const std::string& cellRef);
 
+    // Splits an optional sheet prefix off a cell reference (e.g., "Sheet2!A1" -> prefix "Sheet2!", returns "A1")
+    std::string splitSheetPrefix(const std::string& cellRef, std::string& sheetPrefix);
+
 private:
     // Parses a range of cells (e.g., "A1..B2") and returns a list of individual cell references
     std::vector<std::string> parseRange(const std::string& range);
@@ -0,0 +1,69 @@
+#include "InternedString.h"
+#include <tuple>
+
+InternedString::InternedString() : entry(nullptr) {}
+
+InternedString::InternedString(const std::string& text)
+    : entry(text.empty() ? nullptr : StringPool::instance().acquire(text)) {}
+
+InternedString::InternedString(const char* text) : InternedString(std::string(text)) {}
+
+InternedString::InternedString(const InternedString& other) : entry(other.entry) {
+    // other holds a reference, so the entry cannot disappear while we add ours
+    if (entry) entry->second.fetch_add(1, std::memory_order_relaxed);
+}
+
+InternedString& InternedString::operator=(const InternedString& other) {
+    if (entry != other.entry) {
+        InternedString copy(other); // Take the new reference before dropping the old one
+        std::swap(entry, copy.entry);
+    }
+    return *this;
+}
+
+InternedString::~InternedString() {
+    if (entry) StringPool::instance().release(entry);
+}
+
+const std::string& InternedString::str() const {
+    static const std::string emptyString;
+    return entry ? entry->first : emptyString;
+}
+
+std::ostream& operator<<(std::ostream& out, const InternedString& text) {
+    return out << text.str();
+}
+
+StringPool& StringPool::instance() {
+    static StringPool pool;
+    return pool;
+}
+
+size_t StringPool::size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+InternedString::Entry* StringPool::acquire(const std::string& text) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(text);
+    if (it == entries.end()) {
+        it = entries.emplace(std::piecewise_construct, std::forward_as_tuple(text), std::forward_as_tuple(0)).first;
+    }
+    it->second.fetch_add(1, std::memory_order_relaxed);
+    return &*it;
+}
+
+void StringPool::release(InternedString::Entry* entry) {
+    // Fast path: other handles remain, so no lock is needed
+    int refs = entry->second.load(std::memory_order_relaxed);
+    while (refs > 1) {
+        if (entry->second.compare_exchange_weak(refs, refs - 1, std::memory_order_acq_rel)) return;
+    }
+
+    // Possibly the last handle: decide under the lock, since acquire may be reviving the entry
+    std::lock_guard<std::mutex> lock(mutex);
+    if (entry->second.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        entries.erase(entries.find(entry->first)); // Erase by iterator: the key lives inside the node
+    }
+}
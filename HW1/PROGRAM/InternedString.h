@@ -0,0 +1,63 @@
+#ifndef INTERNEDSTRING_H
+#define INTERNEDSTRING_H
+
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Reference-counted handle to a string stored once in the shared StringPool. Cells with the same
+// content (repeated labels, copy-filled formulas) share one copy, and copying a handle only bumps
+// a counter. The empty string needs no pool entry, so empty cells cost a single null pointer.
+class InternedString {
+public:
+    InternedString(); // Creates an empty string
+    InternedString(const std::string& text); // Interns text (implicit so std::string can be passed anywhere a handle is expected)
+    InternedString(const char* text); // Interns a C string
+    InternedString(const InternedString& other); // Shares other's entry
+    InternedString& operator=(const InternedString& other); // Shares other's entry and releases the old one
+    ~InternedString(); // Releases the entry; the last handle removes it from the pool
+
+    const std::string& str() const; // Returns the interned text
+    operator const std::string&() const { return str(); } // Lets handles be used where a string is expected
+    const char* c_str() const { return str().c_str(); } // Returns the text as a C string
+    bool empty() const { return entry == nullptr; } // Checks if the string is empty
+
+    // Equal strings always share an entry, so comparing handles is a pointer comparison
+    bool operator==(const InternedString& other) const { return entry == other.entry; }
+    bool operator!=(const InternedString& other) const { return entry != other.entry; }
+
+private:
+    typedef std::pair<const std::string, std::atomic<int>> Entry; // Pool node: text and number of handles
+    friend class StringPool;
+
+    Entry* entry; // Shared pool node (nullptr for the empty string)
+};
+
+// Writes the interned text to a stream
+std::ostream& operator<<(std::ostream& out, const InternedString& text);
+
+// Process-wide set of interned strings. Interning and releasing the last handle lock a mutex,
+// so sheets on the UI thread and on background workers can share the pool.
+class StringPool {
+public:
+    static StringPool& instance(); // Returns the shared pool
+
+    size_t size(); // Returns the number of distinct strings currently held
+
+private:
+    friend class InternedString;
+
+    InternedString::Entry* acquire(const std::string& text); // Finds or adds an entry and takes a reference
+    void release(InternedString::Entry* entry); // Drops a reference, removing the entry when it was the last one
+
+    std::mutex mutex; // Guards entries
+    std::unordered_map<std::string, std::atomic<int>> entries; // Text -> number of handles (nodes never move)
+};
+
+// Raw contents of a sheet, row by row, as used by load, save and import/export
+typedef std::vector<std::vector<InternedString>> SheetData;
+
+#endif // INTERNEDSTRING_H
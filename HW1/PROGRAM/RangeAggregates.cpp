@@ -0,0 +1,83 @@
+#include "RangeAggregates.h"
+#include <algorithm>
+#include <limits>
+
+void RangeAggregates::invalidate() {
+    columns.clear();
+}
+
+void RangeAggregates::build(int col, const std::vector<std::vector<Cell>>& grid, int rows) {
+    if (col >= static_cast<int>(columns.size())) {
+        columns.resize(col + 1);
+    }
+    ColumnTree& tree = columns[col];
+    tree.size = rows;
+    tree.sum.assign(2 * rows, 0);
+    tree.min.assign(2 * rows, 0);
+    tree.max.assign(2 * rows, 0);
+
+    // Fill the leaves with the cell values, then combine children into parents
+    for (int r = 0; r < rows; ++r) {
+        double value = grid[r][col].numericValue;
+        tree.sum[rows + r] = tree.min[rows + r] = tree.max[rows + r] = value;
+    }
+    for (int i = rows - 1; i > 0; --i) {
+        tree.sum[i] = tree.sum[2 * i] + tree.sum[2 * i + 1];
+        tree.min[i] = std::min(tree.min[2 * i], tree.min[2 * i + 1]);
+        tree.max[i] = std::max(tree.max[2 * i], tree.max[2 * i + 1]);
+    }
+}
+
+void RangeAggregates::update(int row, int col, double value) {
+    if (col >= static_cast<int>(columns.size()) || row >= columns[col].size) return; // Not built; rebuilt on demand
+
+    ColumnTree& tree = columns[col];
+    int i = tree.size + row;
+    tree.sum[i] = tree.min[i] = tree.max[i] = value;
+
+    // Walk up to the root, recombining each parent
+    for (i /= 2; i > 0; i /= 2) {
+        tree.sum[i] = tree.sum[2 * i] + tree.sum[2 * i + 1];
+        tree.min[i] = std::min(tree.min[2 * i], tree.min[2 * i + 1]);
+        tree.max[i] = std::max(tree.max[2 * i], tree.max[2 * i + 1]);
+    }
+}
+
+bool RangeAggregates::query(const std::string& funcName, int startRow, int endRow, int startCol, int endCol,
+                            const std::vector<std::vector<Cell>>& grid, int rows, int cols, double& result) {
+    if (funcName != "SUM" && funcName != "AVER" && funcName != "MIN" && funcName != "MAX") return false;
+    if (startRow < 0 || startCol < 0 || startRow > endRow || startCol > endCol || endRow >= rows || endCol >= cols) return false;
+
+    double sum = 0;
+    double low = std::numeric_limits<double>::infinity();
+    double high = -std::numeric_limits<double>::infinity();
+
+    for (int col = startCol; col <= endCol; ++col) {
+        if (col >= static_cast<int>(columns.size()) || columns[col].size != rows) {
+            build(col, grid, rows);
+        }
+        const ColumnTree& tree = columns[col];
+
+        // Standard bottom-up range query over the half-open leaf interval [l, r)
+        for (int l = startRow + tree.size, r = endRow + 1 + tree.size; l < r; l /= 2, r /= 2) {
+            if (l & 1) {
+                sum += tree.sum[l];
+                low = std::min(low, tree.min[l]);
+                high = std::max(high, tree.max[l]);
+                ++l;
+            }
+            if (r & 1) {
+                --r;
+                sum += tree.sum[r];
+                low = std::min(low, tree.min[r]);
+                high = std::max(high, tree.max[r]);
+            }
+        }
+    }
+
+    if (funcName == "SUM") result = sum;
+    else if (funcName == "AVER") result = sum / ((endRow - startRow + 1) * static_cast<double>(endCol - startCol + 1));
+    else if (funcName == "MIN") result = low;
+    else result = high;
+    return true;
+}
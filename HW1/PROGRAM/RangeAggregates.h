@@ -0,0 +1,35 @@
+#ifndef RANGEAGGREGATES_H
+#define RANGEAGGREGATES_H
+
+#include "Cell.h"
+#include <string>
+#include <vector>
+
+// Per-column segment trees holding the sum, minimum and maximum of cell values, so
+// SUM/AVER/MIN/MAX over any row range cost O(log n) per column instead of visiting every cell.
+// A column's tree is built the first time it is queried and then kept up to date on each write;
+// bulk changes (load, clear, resize) just invalidate the trees so they are rebuilt on demand.
+class RangeAggregates {
+public:
+    void invalidate(); // Drops all trees (after bulk changes or a resize)
+    void update(int row, int col, double value); // Keeps an already built column in sync with a cell write
+
+    // Computes funcName (SUM, AVER, MIN, MAX) over rows [startRow, endRow] and columns [startCol, endCol] (0-based, inclusive);
+    // returns false for other functions or ranges outside the grid
+    bool query(const std::string& funcName, int startRow, int endRow, int startCol, int endCol,
+               const std::vector<std::vector<Cell>>& grid, int rows, int cols, double& result);
+
+private:
+    // Segment tree of one column: node i covers its children 2i and 2i+1, leaves start at index size
+    struct ColumnTree {
+        int size; // Number of rows covered (0 when the tree has not been built)
+        std::vector<double> sum, min, max;
+        ColumnTree() : size(0) {}
+    };
+
+    void build(int col, const std::vector<std::vector<Cell>>& grid, int rows); // Builds a column tree from the grid
+
+    std::vector<ColumnTree> columns; // Trees indexed by column
+};
+
+#endif // RANGEAGGREGATES_H
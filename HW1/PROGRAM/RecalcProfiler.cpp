@@ -0,0 +1,173 @@
+#include "RecalcProfiler.h"
+#include <algorithm>
+#include <iomanip>
+#include <utility>
+#include <vector>
+
+RecalcProfiler::ScopedTimer::ScopedTimer(RecalcProfiler& profiler, const std::string& cellName)
+    : profiler(profiler), active(profiler.isEnabled()) {
+    if (active) {
+        this->cellName = cellName;
+        start = std::chrono::steady_clock::now();
+    }
+}
+
+RecalcProfiler::ScopedTimer::~ScopedTimer() {
+    if (active) {
+        profiler.recordEvaluation(cellName, elapsedMicros(start));
+    }
+}
+
+RecalcProfiler::RecalcProfiler() : enabled(false) {
+    reset();
+}
+
+void RecalcProfiler::reset() {
+    cellStats.clear();
+    recalcPasses = 0;
+    recalcCells = 0;
+    recalcMicros = 0;
+    largestRecalcOrigin.clear();
+    largestRecalcCells = 0;
+}
+
+double RecalcProfiler::elapsedMicros(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+void RecalcProfiler::recordEvaluation(const std::string& cellName, double micros) {
+    if (!enabled) return;
+    CellStats& stats = cellStats[cellName];
+    stats.evaluations++;
+    stats.totalMicros += micros;
+}
+
+void RecalcProfiler::recordRecalculation(const std::string& origin, size_t cellsRecalculated, double micros) {
+    if (!enabled) return;
+    recalcPasses++;
+    recalcCells += cellsRecalculated;
+    recalcMicros += micros;
+    if (cellsRecalculated > largestRecalcCells) {
+        largestRecalcCells = cellsRecalculated;
+        largestRecalcOrigin = origin;
+    }
+}
+
+RecalcProfiler::SortKey RecalcProfiler::parseSortKey(const std::string& name) {
+    if (name == "count" || name == "c") return SortKey::Count;
+    if (name == "avg" || name == "average" || name == "a") return SortKey::Average;
+    if (name == "name" || name == "n") return SortKey::Name;
+    return SortKey::Time;
+}
+
+void RecalcProfiler::printReport(std::ostream& out, const DependencyGraph& dependencyGraph,
+                                 SortKey sortKey, size_t limit) const {
+    static const char* sortNames[] = { "time", "count", "average", "name" };
+    std::ios::fmtflags oldFlags = out.flags(); // Restored at the end so the caller's formatting is unchanged
+    std::streamsize oldPrecision = out.precision();
+
+    // Sort the per-cell statistics by the requested column
+    std::vector<std::pair<std::string, CellStats>> rows(cellStats.begin(), cellStats.end());
+    auto average = [](const CellStats& s) { return s.evaluations ? s.totalMicros / s.evaluations : 0.0; };
+    std::stable_sort(rows.begin(), rows.end(), [sortKey, &average](const std::pair<std::string, CellStats>& a,
+                                                                   const std::pair<std::string, CellStats>& b) {
+        switch (sortKey) {
+            case SortKey::Count: return a.second.evaluations > b.second.evaluations;
+            case SortKey::Average: return average(a.second) > average(b.second);
+            case SortKey::Name: return a.first < b.first;
+            default: return a.second.totalMicros > b.second.totalMicros;
+        }
+    });
+
+    out << "===== Recalculation Profile (sorted by " << sortNames[static_cast<int>(sortKey)] << ") =====" << std::endl;
+    out << std::left << std::setw(16) << "Cell" << std::setw(10) << "Evals" << std::setw(12) << "Total ms" << "Avg us" << std::endl;
+    for (size_t i = 0; i < rows.size() && i < limit; ++i) {
+        const CellStats& s = rows[i].second;
+        out << std::left << std::setw(16) << rows[i].first << std::setw(10) << s.evaluations
+            << std::setw(12) << std::fixed << std::setprecision(3) << s.totalMicros / 1000.0
+            << std::setprecision(1) << average(s) << std::endl;
+    }
+    if (rows.empty()) {
+        out << "(no evaluations recorded)" << std::endl;
+    }
+
+    out << "Recalculations: " << recalcPasses << " passes, " << recalcCells << " cells, "
+        << std::fixed << std::setprecision(3) << recalcMicros / 1000.0 << " ms";
+    if (largestRecalcCells > 0) {
+        out << " (largest: " << largestRecalcCells << " cells after " << largestRecalcOrigin << ")";
+    }
+    out << std::endl;
+
+    // Longest dependency chain: depth of a cell is one more than the deepest cell it references.
+    // The walk is iterative so very long chains cannot overflow the call stack.
+    std::unordered_map<std::string, int> depth;
+    std::unordered_map<std::string, std::string> deepestInput;
+    std::set<std::string> inProgress;
+    for (const auto& entry : dependencyGraph) {
+        std::vector<std::pair<std::string, bool>> stack{ { entry.first, false } };
+        while (!stack.empty()) {
+            std::pair<std::string, bool> item = stack.back();
+            stack.pop_back();
+
+            auto inputs = dependencyGraph.find(item.first);
+            if (item.second) { // All inputs have been visited
+                int best = 0;
+                if (inputs != dependencyGraph.end()) {
+                    for (const auto& dep : inputs->second) {
+                        auto d = depth.find(dep);
+                        if (d != depth.end() && d->second > best) {
+                            best = d->second;
+                            deepestInput[item.first] = dep;
+                        }
+                    }
+                }
+                depth[item.first] = best + 1;
+                continue;
+            }
+
+            if (depth.count(item.first) || !inProgress.insert(item.first).second) continue; // Done or part of a cycle
+            stack.push_back({ item.first, true });
+            if (inputs != dependencyGraph.end()) {
+                for (const auto& dep : inputs->second) {
+                    if (!depth.count(dep) && !inProgress.count(dep)) stack.push_back({ dep, false });
+                }
+            }
+        }
+    }
+
+    std::string chainEnd;
+    int chainLength = 0;
+    for (const auto& entry : depth) {
+        if (entry.second > chainLength || (entry.second == chainLength && entry.first < chainEnd)) {
+            chainLength = entry.second;
+            chainEnd = entry.first;
+        }
+    }
+    std::vector<std::string> chain;
+    for (std::string cell = chainEnd; !cell.empty();) {
+        chain.push_back(cell);
+        auto next = deepestInput.find(cell);
+        cell = (next != deepestInput.end()) ? next->second : "";
+    }
+    out << "Longest dependency chain (" << chain.size() << " cells): ";
+    for (size_t i = chain.size(); i-- > 0;) {
+        out << chain[i] << (i ? " -> " : "");
+    }
+    out << std::endl;
+
+    // Largest fan-ins: formulas that read the most cells (usually through ranges)
+    std::vector<std::pair<std::string, size_t>> fanIns;
+    for (const auto& entry : dependencyGraph) {
+        if (!entry.second.empty()) fanIns.push_back({ entry.first, entry.second.size() });
+    }
+    std::sort(fanIns.begin(), fanIns.end(), [](const std::pair<std::string, size_t>& a, const std::pair<std::string, size_t>& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    out << "Largest fan-ins:" << std::endl;
+    for (size_t i = 0; i < fanIns.size() && i < limit; ++i) {
+        out << "  " << std::left << std::setw(16) << fanIns[i].first << "reads " << fanIns[i].second << " cells" << std::endl;
+    }
+
+    out.flags(oldFlags);
+    out.precision(oldPrecision);
+}
@@ -0,0 +1,70 @@
+#ifndef RECALCPROFILER_H
+#define RECALCPROFILER_H
+
+#include "DependencyGraph.h"
+#include <chrono>
+#include <ostream>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+// Collects per-cell formula evaluation counts and times, plus recalculation totals,
+// and prints them together with the longest dependency chain and largest range fan-ins
+class RecalcProfiler {
+public:
+    // Columns the per-cell report can be sorted by
+    enum class SortKey { Time, Count, Average, Name };
+
+    // Evaluation statistics of a single cell
+    struct CellStats {
+        long long evaluations; // Number of times the formula was evaluated
+        double totalMicros; // Cumulative evaluation time in microseconds
+        CellStats() : evaluations(0), totalMicros(0) {}
+    };
+
+    // Measures the time between construction and destruction and records it for one cell
+    // (when the profiler is off, it neither copies the name nor reads the clock)
+    class ScopedTimer {
+    public:
+        ScopedTimer(RecalcProfiler& profiler, const std::string& cellName);
+        ~ScopedTimer();
+    private:
+        RecalcProfiler& profiler;
+        bool active; // Whether the profiler was on when the timer started
+        std::string cellName;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    RecalcProfiler(); // Creates a disabled profiler with no data
+
+    void setEnabled(bool on) { enabled = on; } // Turns recording on or off
+    bool isEnabled() const { return enabled; } // Checks if recording is on
+    void reset(); // Discards all recorded data
+
+    // Records one formula evaluation of a cell
+    void recordEvaluation(const std::string& cellName, double micros);
+
+    // Records one pass that recalculated the dependents of a changed cell
+    void recordRecalculation(const std::string& origin, size_t cellsRecalculated, double micros);
+
+    // Prints the report; the dependency graph maps each formula cell to the cells it references
+    void printReport(std::ostream& out, const DependencyGraph& dependencyGraph,
+                     SortKey sortKey, size_t limit = 10) const;
+
+    // Converts a name such as "time", "count", "avg" or "name" to a sort key (defaults to time)
+    static SortKey parseSortKey(const std::string& name);
+
+    // Returns microseconds elapsed since the given time point
+    static double elapsedMicros(std::chrono::steady_clock::time_point start);
+
+private:
+    bool enabled; // Whether evaluations are being recorded
+    std::unordered_map<std::string, CellStats> cellStats; // Statistics per cell name
+    long long recalcPasses; // Number of recalculation passes
+    long long recalcCells; // Total number of cells recalculated over all passes
+    double recalcMicros; // Total recalculation time in microseconds
+    std::string largestRecalcOrigin; // Changed cell that triggered the largest pass
+    size_t largestRecalcCells; // Number of cells recalculated by the largest pass
+};
+
+#endif // RECALCPROFILER_H
@@ -0,0 +1,249 @@
+#include "RecalcTrace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+
+static const char traceMagic[] = { 'R', 'T', 'R', 'C' };
+static const char traceVersion = 1;
+
+// Helper function: Checks if two results are equal within a relative tolerance (errors compare as NaN)
+static bool sameResult(double a, double b, double tolerance) {
+    if (std::isnan(a) || std::isnan(b)) return std::isnan(a) && std::isnan(b);
+    return a == b || std::fabs(a - b) <= tolerance * std::max(std::fabs(a), std::fabs(b));
+}
+
+// Helper function: Prefixes a reference with the sheet of the cell that read it, unless it has its own
+static std::string qualifyInput(const std::string& cellName, const std::string& ref) {
+    auto bang = cellName.find('!');
+    if (bang == std::string::npos || ref.find('!') != std::string::npos) return ref;
+    return cellName.substr(0, bang + 1) + ref;
+}
+
+// Reads the variable-length and fixed-size fields written by RecalcTrace
+class TraceReader {
+public:
+    explicit TraceReader(std::istream& in) : in(in) {}
+
+    bool readVarint(uint64_t& number) {
+        number = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            int byte = in.get();
+            if (byte == EOF) return false;
+            number |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    bool readDouble(double& number) {
+        unsigned char bytes[8];
+        if (!in.read(reinterpret_cast<char*>(bytes), 8)) return false;
+        uint64_t bits = 0;
+        for (int i = 7; i >= 0; --i) bits = (bits << 8) | bytes[i];
+        std::memcpy(&number, &bits, sizeof(number));
+        return true;
+    }
+
+    bool readString(std::string& text) {
+        uint64_t id;
+        if (!readVarint(id)) return false;
+        if (id < strings.size()) {
+            text = strings[id];
+            return true;
+        }
+        if (id != strings.size()) return false; // New strings are numbered in order
+
+        uint64_t length;
+        if (!readVarint(length)) return false;
+        text.resize(length);
+        if (length > 0 && !in.read(&text[0], length)) return false;
+        strings.push_back(text);
+        return true;
+    }
+
+private:
+    std::istream& in;
+    std::vector<std::string> strings; // Strings seen so far, by number
+};
+
+// Supplies the recorded inputs of one evaluation during a replay
+class ReplayValues : public CellValueProvider {
+public:
+    explicit ReplayValues(const std::vector<RecalcTrace::Input>& inputs) {
+        for (const auto& input : inputs) values[input.name] = input.value;
+    }
+
+    bool getValue(const std::string& cellRef, double& value) const override {
+        auto it = values.find(cellRef);
+        if (it == values.end()) return false;
+        value = it->second;
+        return true;
+    }
+
+    bool aggregate(const std::string& funcName, const std::string& range, double& result) const override {
+        return getValue(funcName + "(" + range + ")", result);
+    }
+
+private:
+    std::unordered_map<std::string, double> values;
+};
+
+bool RecalcTrace::RecordingValues::getValue(const std::string& cellRef, double& value) const {
+    if (!source.getValue(cellRef, value)) return false;
+    inputs.push_back({ cellRef, value });
+    return true;
+}
+
+bool RecalcTrace::RecordingValues::aggregate(const std::string& funcName, const std::string& range, double& result) const {
+    if (!source.aggregate(funcName, range, result)) return false; // The cells it visits instead are recorded one by one
+    inputs.push_back({ funcName + "(" + range + ")", result });
+    return true;
+}
+
+RecalcTrace::RecalcTrace() {}
+
+bool RecalcTrace::open(const std::string& filename) {
+    close();
+    file.open(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+
+    file.write(traceMagic, sizeof(traceMagic));
+    file.put(traceVersion);
+    return true;
+}
+
+void RecalcTrace::close() {
+    if (file.is_open()) file.close();
+    stringIds.clear();
+}
+
+void RecalcTrace::record(const std::string& cellName, const std::string& formula, const std::vector<Input>& inputs, double result, bool failed) {
+    if (!isOpen()) return;
+
+    writeString(cellName);
+    writeString(formula);
+    writeVarint(inputs.size());
+    for (const auto& input : inputs) {
+        writeString(input.name);
+        writeDouble(input.value);
+    }
+    writeDouble(result);
+    file.put(failed ? 1 : 0);
+}
+
+void RecalcTrace::writeVarint(uint64_t number) {
+    // Seven bits per byte, lowest first; the high bit marks that more bytes follow
+    while (number >= 0x80) {
+        file.put(static_cast<char>((number & 0x7f) | 0x80));
+        number >>= 7;
+    }
+    file.put(static_cast<char>(number));
+}
+
+void RecalcTrace::writeDouble(double number) {
+    uint64_t bits;
+    std::memcpy(&bits, &number, sizeof(bits));
+    for (int i = 0; i < 8; ++i) {
+        file.put(static_cast<char>(bits & 0xff));
+        bits >>= 8;
+    }
+}
+
+void RecalcTrace::writeString(const std::string& text) {
+    auto it = stringIds.find(text);
+    if (it != stringIds.end()) {
+        writeVarint(it->second);
+        return;
+    }
+
+    // First occurrence: the next number, followed by the text itself
+    uint64_t id = stringIds.size();
+    stringIds[text] = id;
+    writeVarint(id);
+    writeVarint(text.size());
+    file.write(text.data(), text.size());
+}
+
+bool RecalcTrace::read(const std::string& filename, std::vector<Record>& records) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in.is_open()) return false;
+
+    char header[sizeof(traceMagic) + 1];
+    if (!in.read(header, sizeof(header)) || std::memcmp(header, traceMagic, sizeof(traceMagic)) != 0 ||
+        header[sizeof(traceMagic)] != traceVersion) {
+        return false;
+    }
+
+    records.clear();
+    TraceReader reader(in);
+    Record record;
+    while (reader.readString(record.cellName)) {
+        uint64_t count;
+        if (!reader.readString(record.formula) || !reader.readVarint(count)) return false;
+
+        record.inputs.resize(count);
+        for (auto& input : record.inputs) {
+            if (!reader.readString(input.name) || !reader.readDouble(input.value)) return false;
+        }
+
+        int failed;
+        if (!reader.readDouble(record.result) || (failed = in.get()) == EOF) return false;
+        record.failed = failed != 0;
+        records.push_back(record);
+    }
+    return true;
+}
+
+size_t RecalcTrace::replay(const std::vector<Record>& records, std::ostream& out, double tolerance) {
+    FormulaParser parser;
+    size_t problems = 0;
+
+    // Position in the trace of the latest evaluation of each cell
+    std::map<std::string, size_t> lastEvaluation;
+
+    for (size_t i = 0; i < records.size(); ++i) {
+        const Record& record = records[i];
+        lastEvaluation[record.cellName] = i;
+
+        // Re-evaluate with exactly the values the original evaluation saw
+        double result = 0;
+        bool failed = false;
+        std::string error;
+        try {
+            result = parser.parse(record.formula, ReplayValues(record.inputs));
+        } catch (const std::exception& e) {
+            failed = true;
+            error = e.what();
+        }
+
+        if (failed != record.failed || (!failed && !sameResult(result, record.result, tolerance))) {
+            ++problems;
+            out << "#" << i << " " << record.cellName << " " << record.formula << ": recorded ";
+            if (record.failed) out << "error"; else out << record.result;
+            out << ", replayed ";
+            if (failed) out << "error (" << error << ")"; else out << result;
+            out << "\n";
+        }
+    }
+
+    // A cell is stale if something it read was recalculated to a different value afterwards
+    // and the cell itself was never evaluated again
+    for (const auto& entry : lastEvaluation) {
+        const Record& record = records[entry.second];
+        for (const auto& input : record.inputs) {
+            auto source = lastEvaluation.find(qualifyInput(record.cellName, input.name));
+            if (source == lastEvaluation.end() || source->second < entry.second) continue;
+
+            const Record& later = records[source->second];
+            if (!later.failed && !sameResult(later.result, input.value, tolerance)) {
+                ++problems;
+                out << "#" << entry.second << " " << record.cellName << " is stale: read " << input.name << " = " << input.value
+                    << ", but #" << source->second << " recalculated it to " << later.result << "\n";
+            }
+        }
+    }
+
+    out << "Replayed " << records.size() << " evaluations: " << problems << (problems == 1 ? " problem" : " problems") << "\n";
+    return problems;
+}
@@ -0,0 +1,92 @@
+#ifndef RECALCTRACE_H
+#define RECALCTRACE_H
+
+#include "FormulaParser.h"
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Optional log of every formula evaluation: the cell, the formula, each input value it read and
+// the result. The log is a compact binary file that can be replayed later against the current
+// formula engine to find results that changed, and inputs that were stale when they were read.
+//
+// File layout: the magic bytes "RTRC" and a version byte, then one record per evaluation:
+//   cell, formula, input count, (input name, input value) * count, result, failed flag
+// Strings are written once and referred to by number afterwards; counts and string numbers are
+// variable-length integers, and numbers are 8-byte little-endian doubles.
+class RecalcTrace {
+public:
+    // A value a formula read: a cell (e.g., A1 or Sheet2!A1) or a range function (e.g., SUM(A1..A9))
+    struct Input {
+        std::string name;
+        double value;
+    };
+
+    // One formula evaluation
+    struct Record {
+        std::string cellName; // Evaluated cell (qualified with the sheet name in a workbook)
+        std::string formula; // Formula text after named ranges were expanded
+        std::vector<Input> inputs; // Values read, in the order they were read
+        double result; // Computed value (0 if the evaluation failed)
+        bool failed; // Whether the evaluation threw an error
+    };
+
+    // Forwards lookups to another provider and remembers every value it hands out
+    class RecordingValues : public CellValueProvider {
+    public:
+        explicit RecordingValues(const CellValueProvider& source) : source(source) {}
+        bool getValue(const std::string& cellRef, double& value) const override;
+        bool aggregate(const std::string& funcName, const std::string& range, double& result) const override;
+        const std::vector<Input>& getInputs() const { return inputs; }
+    private:
+        const CellValueProvider& source;
+        mutable std::vector<Input> inputs;
+    };
+
+    RecalcTrace(); // Creates a closed trace (nothing is recorded)
+
+    bool open(const std::string& filename); // Starts a new trace file; returns false if it cannot be created
+    void close(); // Finishes the trace file
+    bool isOpen() const { return file.is_open(); } // Checks if evaluations are being recorded
+
+    // Runs calculate(values) and, while the trace is open, records its inputs and result (errors are rethrown)
+    template <typename Calculate>
+    double evaluate(const std::string& cellName, const std::string& formula, const CellValueProvider& values, Calculate calculate) {
+        if (!isOpen()) return calculate(values);
+
+        RecordingValues recording(values);
+        double result;
+        try {
+            result = calculate(static_cast<const CellValueProvider&>(recording));
+        } catch (...) {
+            record(cellName, formula, recording.getInputs(), 0, true);
+            throw;
+        }
+        record(cellName, formula, recording.getInputs(), result, false);
+        return result;
+    }
+
+    // Appends one evaluation to the trace file
+    void record(const std::string& cellName, const std::string& formula, const std::vector<Input>& inputs, double result, bool failed);
+
+    // Reads every record of a trace file; returns false if it cannot be opened or is not a trace
+    static bool read(const std::string& filename, std::vector<Record>& records);
+
+    // Re-evaluates every record with its recorded inputs and prints results that differ by more than
+    // the relative tolerance, and inputs that do not match the latest recorded result of that cell.
+    // Returns the number of problems found.
+    static size_t replay(const std::vector<Record>& records, std::ostream& out, double tolerance = 1e-9);
+
+private:
+    void writeVarint(uint64_t number);
+    void writeDouble(double number);
+    void writeString(const std::string& text);
+
+    std::ofstream file; // Trace being written
+    std::unordered_map<std::string, uint64_t> stringIds; // Strings already written, by number
+};
+
+#endif // RECALCTRACE_H
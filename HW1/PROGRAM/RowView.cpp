@@ -0,0 +1,217 @@
+#include "RowView.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+
+// Helper function: Gets the numeric value of a cell; returns false for labels and empty cells
+static bool numericValueOf(const Cell& cell, double& number) {
+    number = cell.numericValue; // Computed for formulas, parsed once for values when they were set
+    return cell.isFormula || cell.isNumber;
+}
+
+// Helper function: Removes leading and trailing spaces
+static std::string trim(const std::string& text) {
+    size_t start = text.find_first_not_of(" \t");
+    if (start == std::string::npos) return "";
+    size_t end = text.find_last_not_of(" \t");
+    return text.substr(start, end - start + 1);
+}
+
+// Helper function: Converts column letters (e.g., A, C, AB) to a column index
+static int parseColumn(const std::string& letters) {
+    if (letters.empty()) {
+        throw std::invalid_argument("Missing column name");
+    }
+    int col = 0;
+    for (char ch : letters) {
+        if (!std::isalpha(ch)) {
+            throw std::invalid_argument("Invalid column name: " + letters);
+        }
+        col = col * 26 + (std::toupper(ch) - 'A' + 1);
+    }
+    return col - 1;
+}
+
+// Helper function: Checks if a cell passes one filter condition
+static bool passesFilter(const Cell& cell, const RowFilter& filter) {
+    std::string text = cell.getDisplayValue();
+    if (filter.op == "contains") {
+        return text.find(filter.operand) != std::string::npos;
+    }
+
+    // Compare numerically when both sides are numbers, otherwise as text
+    double cellNumber, operandNumber;
+    char* end;
+    operandNumber = std::strtod(filter.operand.c_str(), &end);
+    bool operandIsNumber = !filter.operand.empty() && *end == '\0';
+
+    int cmp;
+    if (operandIsNumber && numericValueOf(cell, cellNumber)) {
+        cmp = (cellNumber < operandNumber) ? -1 : (cellNumber > operandNumber ? 1 : 0);
+    } else {
+        cmp = text.compare(filter.operand);
+    }
+
+    if (filter.op == "=") return cmp == 0;
+    if (filter.op == "!=") return cmp != 0;
+    if (filter.op == "<") return cmp < 0;
+    if (filter.op == "<=") return cmp <= 0;
+    if (filter.op == ">") return cmp > 0;
+    return cmp >= 0; // ">="
+}
+
+RowView::RowView() : active(false) {}
+
+void RowView::reset() {
+    active = false;
+    order.clear();
+    order.shrink_to_fit();
+}
+
+int RowView::size(int gridRows) const {
+    return active ? static_cast<int>(order.size()) : gridRows;
+}
+
+int RowView::gridRow(int position) const {
+    return active ? order[position] : position;
+}
+
+void RowView::activate(int rows) {
+    if (active) return;
+    order.resize(rows);
+    for (int r = 0; r < rows; ++r) {
+        order[r] = r;
+    }
+    active = true;
+}
+
+void RowView::sort(const std::vector<std::vector<Cell>>& grid, int rows, const std::vector<SortColumn>& keys, int headerRows) {
+    activate(rows);
+    if (keys.empty()) return;
+
+    // Extract each key once per row so the comparator never parses cell text:
+    // kind 0 = number, 1 = label, 2 = empty (numbers first, empty cells always last)
+    std::vector<std::vector<char>> kinds(keys.size(), std::vector<char>(rows, 2));
+    std::vector<std::vector<double>> numbers(keys.size(), std::vector<double>(rows, 0));
+    for (size_t k = 0; k < keys.size(); ++k) {
+        for (int r : order) {
+            if (keys[k].col >= static_cast<int>(grid[r].size())) continue;
+            const Cell& cell = grid[r][keys[k].col];
+            if (numericValueOf(cell, numbers[k][r])) {
+                kinds[k][r] = 0;
+            } else if (!cell.value.empty()) {
+                kinds[k][r] = 1;
+            }
+        }
+    }
+
+    auto less = [&](int a, int b) {
+        for (size_t k = 0; k < keys.size(); ++k) {
+            char kindA = kinds[k][a], kindB = kinds[k][b];
+            if (kindA != kindB) return kindA < kindB;
+            if (kindA == 0 && numbers[k][a] != numbers[k][b]) {
+                return keys[k].ascending ? numbers[k][a] < numbers[k][b] : numbers[k][a] > numbers[k][b];
+            }
+            if (kindA == 1) {
+                const InternedString& labelA = grid[a][keys[k].col].value;
+                const InternedString& labelB = grid[b][keys[k].col].value;
+                if (labelA == labelB) continue; // Same pooled string, no need to compare characters
+                int cmp = labelA.str().compare(labelB.str());
+                if (cmp != 0) return keys[k].ascending ? cmp < 0 : cmp > 0;
+            }
+        }
+        return false; // Equal keys keep their current order (stable sort)
+    };
+
+    int fixedRows = std::min(std::max(headerRows, 0), static_cast<int>(order.size()));
+    std::stable_sort(order.begin() + fixedRows, order.end(), less);
+}
+
+void RowView::filter(const std::vector<std::vector<Cell>>& grid, int rows, const std::vector<RowFilter>& filters, int headerRows) {
+    activate(rows);
+
+    // Compact the order in place, keeping header rows and rows that pass every filter
+    size_t kept = 0;
+    for (size_t pos = 0; pos < order.size(); ++pos) {
+        int r = order[pos];
+        bool keep = static_cast<int>(pos) < headerRows;
+        if (!keep) {
+            keep = true;
+            for (const auto& f : filters) {
+                if (f.col >= static_cast<int>(grid[r].size()) || !passesFilter(grid[r][f.col], f)) {
+                    keep = false;
+                    break;
+                }
+            }
+        }
+        if (keep) order[kept++] = r;
+    }
+    order.resize(kept);
+}
+
+std::vector<SortColumn> RowView::parseSortSpec(const std::string& spec) {
+    std::vector<SortColumn> keys;
+    std::istringstream stream(spec);
+    std::string part;
+
+    // Split the specification by commas (e.g., "A,-C")
+    while (std::getline(stream, part, ',')) {
+        part = trim(part);
+        if (part.empty()) continue;
+
+        SortColumn key;
+        key.ascending = part[0] != '-';
+        if (part[0] == '-' || part[0] == '+') part = trim(part.substr(1));
+        key.col = parseColumn(part);
+        keys.push_back(key);
+    }
+
+    if (keys.empty()) {
+        throw std::invalid_argument("No sort columns given");
+    }
+    return keys;
+}
+
+std::vector<RowFilter> RowView::parseFilterSpec(const std::string& spec) {
+    std::vector<RowFilter> filters;
+    std::istringstream stream(spec);
+    std::string part;
+
+    // Split the specification by commas (e.g., "B > 10, C contains abc")
+    while (std::getline(stream, part, ',')) {
+        part = trim(part);
+        if (part.empty()) continue;
+
+        RowFilter filter;
+        size_t opStart, opEnd;
+        size_t containsPos = part.find(" contains ");
+        if (containsPos != std::string::npos) {
+            opStart = containsPos + 1;
+            opEnd = opStart + 8;
+            filter.op = "contains";
+        } else {
+            opStart = part.find_first_of("<>=!");
+            if (opStart == std::string::npos) {
+                throw std::invalid_argument("Missing operator in filter: " + part);
+            }
+            opEnd = part.find_first_not_of("<>=!", opStart);
+            if (opEnd == std::string::npos) opEnd = part.size();
+            filter.op = part.substr(opStart, opEnd - opStart);
+            if (filter.op != "=" && filter.op != "!=" && filter.op != "<" && filter.op != "<=" &&
+                filter.op != ">" && filter.op != ">=") {
+                throw std::invalid_argument("Invalid operator in filter: " + filter.op);
+            }
+        }
+
+        filter.col = parseColumn(trim(part.substr(0, opStart)));
+        filter.operand = trim(part.substr(opEnd));
+        filters.push_back(filter);
+    }
+
+    if (filters.empty()) {
+        throw std::invalid_argument("No filter conditions given");
+    }
+    return filters;
+}
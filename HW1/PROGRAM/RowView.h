@@ -0,0 +1,51 @@
+#ifndef ROWVIEW_H
+#define ROWVIEW_H
+
+#include "Cell.h"
+#include <string>
+#include <vector>
+
+// Column used as a sort key (e.g., -B sorts column B in descending order)
+struct SortColumn {
+    int col; // Column index
+    bool ascending; // Sort direction
+};
+
+// Condition a row must meet to stay visible (e.g., B > 10 or C contains abc)
+struct RowFilter {
+    int col; // Column index
+    std::string op; // One of =, !=, <, <=, >, >=, contains
+    std::string operand; // Value compared against (numeric comparison when both sides are numbers)
+};
+
+// Ordered subset of a spreadsheet's rows used for display. Sorting and filtering only reorder
+// row indices; cells never move, so formulas keep pointing at the same underlying cells.
+class RowView {
+public:
+    RowView(); // Creates an inactive view that shows every row in grid order
+
+    bool isActive() const { return active; } // Checks if a sort or filter is applied
+    void reset(); // Removes all sorting and filtering
+    int size(int gridRows) const; // Returns the number of rows in the view
+    int gridRow(int position) const; // Converts a position in the view to a grid row index
+
+    // Stable multi-key sort of the rows currently in the view; the first headerRows rows stay on top
+    void sort(const std::vector<std::vector<Cell>>& grid, int rows, const std::vector<SortColumn>& keys, int headerRows);
+
+    // Keeps only the rows in the view that pass every filter; the first headerRows rows always stay
+    void filter(const std::vector<std::vector<Cell>>& grid, int rows, const std::vector<RowFilter>& filters, int headerRows);
+
+    // Parses a sort specification such as "A,-C" (minus means descending)
+    static std::vector<SortColumn> parseSortSpec(const std::string& spec);
+
+    // Parses filter conditions such as "B > 10, C contains abc" (comma separated, all must hold)
+    static std::vector<RowFilter> parseFilterSpec(const std::string& spec);
+
+private:
+    void activate(int rows); // Materializes the identity order before the first sort or filter
+
+    bool active; // Whether order holds a sorted or filtered row list
+    std::vector<int> order; // Grid row index for each view position
+};
+
+#endif // ROWVIEW_H
@@ -21,12 +21,15 @@ void Spreadsheet::updateCellContent(int row, int col, const std::string& content
         return;
     }
 
-    grid[row][col].setValue(content); // Write the content into the cell
+    setCellValue(row, col, content); // Write the content into the cell
     display(10, 10, row, col); // Refresh the display with updated content
 }
 
 // Constructor to initialize the spreadsheet with a specific number of rows and columns
-Spreadsheet::Spreadsheet(int rows, int cols) : rows(rows), cols(cols), horizontalOffset(0), verticalOffset(0) {
+Spreadsheet::Spreadsheet(int rows, int cols)
+    : graphArena(new Arena()), dependencyGraph(makeDependencyGraph(*graphArena)),
+      reverseDependencyGraph(makeDependencyGraph(*graphArena)), rows(rows), cols(cols), lazyEvaluation(false),
+      pendingCount(0), pendingScanRow(0), horizontalOffset(0), verticalOffset(0) {
     grid.resize(rows, std::vector<Cell>(cols)); // Create the grid with specified dimensions
 }
 
@@ -36,11 +39,21 @@ void Spreadsheet::display(int visibleRows, int visibleCols, int selectedRow, int
     auto clearLine = []() { std::cout << "\033[2K"; };
 
     // Highlight information about the selected cell
-    std::string selectedCellName = columnName(selectedCol) + std::to_string(selectedRow + 1);
-    const Cell& selectedCell = grid[selectedRow][selectedCol]; // Get the selected cell
+    int selectedGridRow = view.gridRow(selectedRow); // The selected row is a position in the (possibly sorted) view
+    if (pendingCount > 0) {
+        // Compute pending formulas on screen before drawing them
+        std::vector<int> visibleGridRows;
+        for (int pos = verticalOffset; pos < std::min(verticalOffset + visibleRows, view.size(rows)); ++pos) {
+            visibleGridRows.push_back(view.gridRow(pos));
+        }
+        evaluateVisible(visibleGridRows, horizontalOffset, visibleCols);
+        ensureEvaluated(selectedGridRow, selectedCol);
+    }
+    std::string selectedCellName = columnName(selectedCol) + std::to_string(selectedGridRow + 1);
+    const Cell& selectedCell = grid[selectedGridRow][selectedCol]; // Get the selected cell
     std::string cellType = selectedCell.getType(); // Get the type of the cell ("V", "L", or "F")
     std::string cellDisplayValue = selectedCell.getDisplayValue(); // Get the value to display in the cell
-    std::string cellRawValue = selectedCell.value; // Get the raw content of the cell
+    const std::string& cellRawValue = selectedCell.value.str(); // Get the raw content of the cell
 
     // Display the header row with selected cell information
     std::cout << "\033[1;1H"; // Move the cursor to the first line
@@ -65,8 +78,10 @@ void Spreadsheet::display(int visibleRows, int visibleCols, int selectedRow, int
     }
     std::cout << std::endl;
 
-    // Display rows and their corresponding cells in the visible range
-    for (int row = verticalOffset; row < std::min(verticalOffset + visibleRows, rows); ++row) {
+    // Display rows and their corresponding cells in the visible range, in view order
+    int viewRows = view.size(rows);
+    for (int pos = verticalOffset; pos < std::min(verticalOffset + visibleRows, viewRows); ++pos) {
+        int row = view.gridRow(pos); // Row labels keep the grid row number so formulas still match
         std::cout << "\033[44m\033[97m" << std::setw(5) << std::left << (row + 1) << "\033[0m";
 
         for (int col = horizontalOffset; col < std::min(horizontalOffset + visibleCols, cols); ++col) {
@@ -76,7 +91,7 @@ void Spreadsheet::display(int visibleRows, int visibleCols, int selectedRow, int
                 cellDisplay = cellDisplay.substr(0, 10); // Truncate long cell content
             }
 
-            if (row == selectedRow && col == selectedCol) { // Highlight the selected cell
+            if (pos == selectedRow && col == selectedCol) { // Highlight the selected cell
                 std::cout << "\033[42m\033[30m" << std::setw(10) << std::left << cellDisplay << "\033[0m";
             } else {
                 std::cout << std::setw(10) << std::left << cellDisplay;
@@ -88,18 +103,154 @@ void Spreadsheet::display(int visibleRows, int visibleCols, int selectedRow, int
 
 // Evaluate a formula by parsing it and calculating its result
 double Spreadsheet::evaluateFormula(const std::string& formula) {
-    std::unordered_map<std::string, double> cellValues;
+    // Cells are read straight from the grid and ranges from the aggregate cache,
+    // so only the cells the formula mentions are touched
+    return evaluateFormula(formula, GridValues(*this));
+}
+
+// Evaluate a formula against an explicit set of cell values
+double Spreadsheet::evaluateFormula(const std::string& formula, const std::unordered_map<std::string, double>& cellValues) {
+    return parser.parse(formula, cellValues);
+}
+
+// Evaluate a formula against a value provider (used by the workbook for cross-sheet references)
+double Spreadsheet::evaluateFormula(const std::string& formula, const CellValueProvider& cellValues) {
+    return parser.parse(formula, cellValues);
+}
+
+// Evaluate the formula of a cell, logging its inputs and result while the trace is open
+double Spreadsheet::evaluateCell(const std::string& cellName, const std::string& formula) {
+    return trace.evaluate(cellName, formula, GridValues(*this),
+                          [&](const CellValueProvider& values) { return parser.parse(formula, values); });
+}
+
+bool Spreadsheet::GridValues::getValue(const std::string& cellRef, double& value) const {
+    return sheet.getValue(cellRef, value);
+}
+
+bool Spreadsheet::GridValues::aggregate(const std::string& funcName, const std::string& range, double& result) const {
+    return sheet.aggregateRange(funcName, range, result);
+}
+
+bool Spreadsheet::getValue(const std::string& cellName, double& value) {
+    int row, col;
+    try {
+        getCellLocation(cellName, row, col);
+    } catch (const std::exception&) {
+        return false; // Not a plain cell name (e.g., a reference to another sheet)
+    }
+    if (row < 0 || col < 0 || row >= rows || col >= cols) return false;
+
+    ensureEvaluated(row, col);
+    value = grid[row][col].numericValue;
+    return true;
+}
 
-    // Collect all numeric values from the spreadsheet cells
-    for (int row = 0; row < rows; ++row) {
-        for (int col = 0; col < cols; ++col) {
-            std::string cellName = columnName(col) + std::to_string(row + 1);
-            cellValues[cellName] = grid[row][col].numericValue; // Store numeric values
+bool Spreadsheet::aggregateRange(const std::string& funcName, const std::string& range, double& result) {
+    auto delimiterPos = range.find("..");
+    if (delimiterPos == std::string::npos || range.find('!') != std::string::npos) return false;
+
+    int startRow, startCol, endRow, endCol;
+    try {
+        getCellLocation(range.substr(0, delimiterPos), startRow, startCol);
+        getCellLocation(range.substr(delimiterPos + 2), endRow, endCol);
+    } catch (const std::exception&) {
+        return false; // Let the parser report the malformed range
+    }
+
+    // Pending cells in the range must have their values before they are summed up
+    if (pendingCount > 0) {
+        for (int r = std::max(startRow, 0); r <= std::min(endRow, rows - 1); ++r) {
+            for (int c = std::max(startCol, 0); c <= std::min(endCol, cols - 1); ++c) {
+                ensureEvaluated(r, c);
+            }
         }
     }
 
-    // Parse the formula and return the calculated result
-    return parser.parse(formula, cellValues);
+    return aggregates.query(funcName, startRow, endRow, startCol, endCol, grid, rows, cols, result);
+}
+
+void Spreadsheet::setCellValue(int row, int col, const std::string& value) {
+    clearPending(row, col);
+    grid[row][col].setValue(value);
+    aggregates.update(row, col, grid[row][col].numericValue);
+}
+
+void Spreadsheet::setNumericValue(int row, int col, double value) {
+    clearPending(row, col);
+    grid[row][col].isCalculating = false;
+    grid[row][col].numericValue = value;
+    aggregates.update(row, col, value);
+}
+
+void Spreadsheet::markCalculating(int row, int col) {
+    if (grid[row][col].isFormula) {
+        grid[row][col].isCalculating = true;
+    }
+}
+
+void Spreadsheet::markPending(int row, int col) {
+    Cell& cell = grid[row][col];
+    if (cell.isFormula && !cell.isPending) {
+        cell.isPending = true;
+        ++pendingCount;
+    }
+}
+
+void Spreadsheet::clearPending(int row, int col) {
+    if (grid[row][col].isPending) {
+        grid[row][col].isPending = false;
+        --pendingCount;
+    }
+}
+
+void Spreadsheet::ensureEvaluated(int row, int col) {
+    if (!grid[row][col].isPending) return;
+
+    // Clear the flag first, so a circular reference reads the old value instead of recursing forever
+    clearPending(row, col);
+    if (pendingEvaluator) {
+        pendingEvaluator(row, col);
+    } else {
+        evaluatePendingCell(row, col);
+    }
+}
+
+void Spreadsheet::evaluatePendingCell(int row, int col) {
+    std::string cellName = getCellName(row, col);
+    RecalcProfiler::ScopedTimer timer(profiler, cellName);
+    try {
+        setNumericValue(row, col, evaluateCell(cellName, grid[row][col].value));
+    } catch (const std::exception& e) {
+        std::cerr << "Error evaluating formula in " << cellName << ": " << e.what() << std::endl;
+        setNumericValue(row, col, 0); // Default value in case of an error
+    }
+}
+
+void Spreadsheet::evaluateVisible(const std::vector<int>& gridRows, int firstCol, int colCount) {
+    for (int r : gridRows) {
+        if (r < 0 || r >= rows) continue;
+        for (int c = std::max(firstCol, 0); c < std::min(firstCol + colCount, cols); ++c) {
+            ensureEvaluated(r, c);
+        }
+    }
+}
+
+size_t Spreadsheet::evaluatePending(size_t maxCells) {
+    // Continue the row-by-row sweep where the previous pass stopped, wrapping around at the end
+    size_t evaluated = 0;
+    for (int scanned = 0; pendingCount > 0 && evaluated < maxCells && scanned <= rows; ++scanned) {
+        if (pendingScanRow >= rows) pendingScanRow = 0;
+        int c = 0;
+        for (; c < cols && evaluated < maxCells; ++c) {
+            if (grid[pendingScanRow][c].isPending) {
+                ensureEvaluated(pendingScanRow, c);
+                ++evaluated;
+            }
+        }
+        if (c == cols) ++pendingScanRow; // Stay on a partly evaluated row for the next pass
+    }
+    return pendingCount;
 }
 
 // Update the dependencies of a cell when its formula changes
@@ -147,6 +298,9 @@ bool Spreadsheet::detectCycle(const std::string& startCell, const std::string& c
 void Spreadsheet::recalculateDependents(const std::string& cellName) {
     std::stack<std::string> toCalculate;
     std::set<std::string> processed;
+    bool profiling = profiler.isEnabled();
+    std::chrono::steady_clock::time_point recalcStart; // Start time for the profiler
+    if (profiling) recalcStart = std::chrono::steady_clock::now();
 
     // Add the initial cell's dependents to the stack
     if (reverseDependencyGraph.find(cellName) != reverseDependencyGraph.end()) {
@@ -170,8 +324,9 @@ void Spreadsheet::recalculateDependents(const std::string& cellName) {
 
         // Recalculate the formula in the current cell if it is a formula
         if (grid[row][col].isFormula) {
+            RecalcProfiler::ScopedTimer timer(profiler, current);
             try {
-                grid[row][col].numericValue = evaluateFormula(grid[row][col].value);
+                setNumericValue(row, col, evaluateCell(current, grid[row][col].value));
             } catch (const std::exception& e) {
                 std::cerr << "Error recalculating " << current << ": " << e.what() << std::endl;
             }
@@ -184,6 +339,8 @@ void Spreadsheet::recalculateDependents(const std::string& cellName) {
             }
         }
     }
+
+    if (profiling) profiler.recordRecalculation(cellName, processed.size(), RecalcProfiler::elapsedMicros(recalcStart));
 }
 
 void Spreadsheet::setCell(int row, int col, const std::string& value) {
@@ -205,15 +362,16 @@ void Spreadsheet::setCell(int row, int col, const std::string& value) {
     }
 
     // Update the cell value
-    grid[row][col].setValue(value);
+    setCellValue(row, col, value);
 
     // If it's a formula, evaluate it and store the result
     if (grid[row][col].isFormula) {
+        RecalcProfiler::ScopedTimer timer(profiler, cellName);
         try {
-            grid[row][col].numericValue = evaluateFormula(value);
+            setNumericValue(row, col, evaluateCell(cellName, value));
         } catch (const std::exception& e) {
             std::cerr << "Error evaluating formula: " << e.what() << std::endl;
-            grid[row][col].numericValue = 0; // Set default value on error
+            setNumericValue(row, col, 0); // Set default value on error
         }
     }
 
@@ -255,7 +413,7 @@ void Spreadsheet::getCellLocation(const std::string& cellName, int& row, int& co
 
 void Spreadsheet::saveSpreadsheet(const std::string& filename) {
     FileManager fileManager;
-    std::vector<std::vector<std::string>> data(rows, std::vector<std::string>(cols));
+    SheetData data(rows, std::vector<InternedString>(cols));
 
     // Prepare the data for saving
     for (int r = 0; r < rows; ++r) {
@@ -273,7 +431,7 @@ void Spreadsheet::saveSpreadsheet(const std::string& filename) {
 
 void Spreadsheet::loadSpreadsheet(const std::string& filename) {
     FileManager fileManager;
-    std::vector<std::vector<std::string>> data;
+    SheetData data;
 
     // Load data from the file
     if (!fileManager.loadFromFile(filename, data)) {
@@ -285,6 +443,7 @@ void Spreadsheet::loadSpreadsheet(const std::string& filename) {
     int newRows = data.size();
     int newCols = newRows > 0 ? data[0].size() : 0;
 
+    view.reset(); // Row indices of the old contents no longer apply
     resizeGrid(newRows, newCols);
 
     // Populate the grid with loaded data
@@ -295,6 +454,7 @@ void Spreadsheet::loadSpreadsheet(const std::string& filename) {
             }
         }
     }
+    aggregates.invalidate(); // Rebuilt on demand from the new contents
 
     // Rebuild dependencies for all formulas
     dependencyGraph.clear(); // Clear the old dependencies
@@ -309,12 +469,17 @@ void Spreadsheet::loadSpreadsheet(const std::string& filename) {
         }
     }
 
-    // Recalculate all formulas
+    // Recalculate all formulas (or leave them pending, to be evaluated when needed)
+    pendingCount = 0; // Every cell was just overwritten
+    pendingScanRow = 0;
     for (int r = 0; r < rows; ++r) {
         for (int c = 0; c < cols; ++c) {
-            if (grid[r][c].isFormula) {
+            if (grid[r][c].isFormula && lazyEvaluation) {
+                markPending(r, c);
+            } else if (grid[r][c].isFormula) {
+                RecalcProfiler::ScopedTimer timer(profiler, profiler.isEnabled() ? getCellName(r, c) : std::string());
                 try {
-                    grid[r][c].numericValue = evaluateFormula(grid[r][c].value);
+                    setNumericValue(r, c, evaluateCell(getCellName(r, c), grid[r][c].value));
                 } catch (const std::exception& e) {
                     std::cerr << "Error evaluating formula in " << getCellName(r, c) << ": " << e.what() << std::endl;
                 }
@@ -330,6 +495,11 @@ void Spreadsheet::loadSpreadsheet(const std::string& filename) {
 }
 
 void Spreadsheet::resizeGrid(int newRows, int newCols) {
+    // A sorted or filtered view may point at rows that are about to disappear
+    if (newRows < rows) {
+        view.reset();
+    }
+
     // Increase the number of rows if needed
     if (newRows > rows) {
         grid.resize(newRows, std::vector<Cell>(cols)); // Allocate space for new rows
@@ -345,11 +515,21 @@ void Spreadsheet::resizeGrid(int newRows, int newCols) {
     // Update the dimensions of the grid
     rows = newRows;
     cols = newCols;
+    aggregates.invalidate(); // Column trees are sized for the old row count
+
+    // Only cells inside the grid count as pending (cells kept from before a shrink may come back)
+    pendingCount = 0;
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            if (grid[r][c].isPending) ++pendingCount;
+        }
+    }
 }
 
-void Spreadsheet::importFromData(const std::vector<std::vector<std::string>>& data) {
+void Spreadsheet::importFromData(const SheetData& data) {
     int newRows = data.size();
     int newCols = data.empty() ? 0 : data[0].size();
+    view.reset(); // Row indices of the old contents no longer apply
     resizeGrid(newRows, newCols);
 
     // Populate the grid with data from the input
@@ -358,23 +538,33 @@ void Spreadsheet::importFromData(const std::vector<std::vector<std::string>>& da
             grid[i][j].setValue(data[i][j]);
         }
     }
+    aggregates.invalidate(); // Rebuilt on demand from the new contents
+    pendingCount = 0; // Every cell was just overwritten
+    pendingScanRow = 0;
 }
 
 void Spreadsheet::clear() {
+    view.reset(); // Show all rows in their original order again
+
     // Reset all cells in the grid to an empty state
     for (auto& row : grid) {
         for (auto& cell : row) {
             cell.setValue(""); // Clear the cell value
         }
     }
+    dependencyGraph.clear(); // No formulas are left (the nodes go back to the arena for reuse)
+    reverseDependencyGraph.clear();
+    aggregates.invalidate();
+    pendingCount = 0;
+    pendingScanRow = 0;
 }
 
-std::vector<std::vector<std::string>> Spreadsheet::exportToData() const {
-    std::vector<std::vector<std::string>> data;
+SheetData Spreadsheet::exportToData() const {
+    SheetData data;
 
     // Extract raw cell values into a 2D vector for export
     for (const auto& row : grid) {
-        std::vector<std::string> rowData;
+        std::vector<InternedString> rowData;
         for (const auto& cell : row) {
             rowData.push_back(cell.value); // Use the raw cell value
         }
@@ -387,8 +577,9 @@ std::vector<std::vector<std::string>> Spreadsheet::exportToData() const {
 void Spreadsheet::autoExpandGrid(int currentRow, int currentCol) {
     bool expanded = false;
 
-    // Automatically expand rows if the last row is reached
-    if (currentRow >= rows - 1) {
+    // Automatically expand rows if the last row is reached (not while sorted or filtered:
+    // the new rows would be missing from the view until it is cleared)
+    if (currentRow >= rows - 1 && !view.isActive()) {
         int newRows = rows + 10; // Add 10 more rows
         resizeGrid(newRows, cols);
         expanded = true;
@@ -411,14 +602,27 @@ void Spreadsheet::evaluateAllFormulas() {
     for (int r = 0; r < rows; ++r) {
         for (int c = 0; c < cols; ++c) {
             if (grid[r][c].isFormula) { // Check if the cell contains a formula
+                RecalcProfiler::ScopedTimer timer(profiler, profiler.isEnabled() ? getCellName(r, c) : std::string());
                 try {
                     // Evaluate the formula and store the result
-                    grid[r][c].numericValue = evaluateFormula(grid[r][c].value);
+                    setNumericValue(r, c, evaluateCell(getCellName(r, c), grid[r][c].value));
                 } catch (const std::exception& e) {
                     std::cerr << "Error evaluating formula in cell " << getCellName(r, c) << ": " << e.what() << std::endl;
-                    grid[r][c].numericValue = 0; // Default value in case of an error
+                    setNumericValue(r, c, 0); // Default value in case of an error
                 }
             }
         }
     }
 }
+
+void Spreadsheet::sortRows(const std::vector<SortColumn>& keys, int headerRows) {
+    view.sort(grid, rows, keys, headerRows);
+}
+
+void Spreadsheet::filterRows(const std::vector<RowFilter>& filters, int headerRows) {
+    view.filter(grid, rows, filters, headerRows);
+}
+
+void Spreadsheet::printProfile(std::ostream& out, RecalcProfiler::SortKey sortKey, size_t limit) const {
+    profiler.printReport(out, dependencyGraph, sortKey, limit);
+}
\ No newline at end of file
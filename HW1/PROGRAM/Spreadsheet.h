@@ -4,6 +4,14 @@
 #include "Cell.h"
 #include "FormulaParser.h"
 #include "FileManager.h"
+#include "DependencyGraph.h"
+#include "RecalcProfiler.h"
+#include "RecalcTrace.h"
+#include "RowView.h"
+#include "RangeAggregates.h"
+#include <functional>
+#include <memory>
+#include <ostream>
 #include <vector>
 #include <string>
 #include <unordered_map>
@@ -13,40 +21,99 @@
 class Spreadsheet {
 private:
     std::vector<std::vector<Cell>> grid; // The grid representing cells of the spreadsheet
-    std::unordered_map<std::string, std::set<std::string>> dependencyGraph; // Tracks dependencies between cells
-    std::unordered_map<std::string, std::set<std::string>> reverseDependencyGraph; // Tracks reverse dependencies
+    std::unique_ptr<Arena> graphArena; // Memory for the graph nodes below (kept at a fixed address when the sheet moves)
+    DependencyGraph dependencyGraph; // Tracks dependencies between cells
+    DependencyGraph reverseDependencyGraph; // Tracks reverse dependencies
 
     int rows, cols; // Number of rows and columns in the spreadsheet
     FormulaParser parser; // Utility to parse and evaluate formulas
+    RecalcProfiler profiler; // Records formula evaluation counts and times when enabled
+    RecalcTrace trace; // Logs every formula evaluation while open
+    RowView view; // Sorted/filtered order of rows used for display
+    mutable RangeAggregates aggregates; // Cached per-column sums/minimums/maximums for range functions
+    bool lazyEvaluation; // Whether loading leaves formulas pending instead of evaluating them
+    size_t pendingCount; // Number of formula cells waiting to be evaluated
+    int pendingScanRow; // Row where the next catch-up pass looks for pending cells
+    std::function<void(int row, int col)> pendingEvaluator; // Evaluates a pending cell (a workbook installs one that sees other sheets)
+
+    // Supplies the parser with values straight from the grid (and range aggregates from the cache)
+    class GridValues : public CellValueProvider {
+    public:
+        explicit GridValues(Spreadsheet& sheet) : sheet(sheet) {}
+        bool getValue(const std::string& cellRef, double& value) const override;
+        bool aggregate(const std::string& funcName, const std::string& range, double& result) const override;
+    private:
+        Spreadsheet& sheet; // Not const: reading a pending cell evaluates it first
+    };
+
+    double evaluateCell(const std::string& cellName, const std::string& formula); // Evaluates a cell's formula, recording it in the trace
+    void evaluatePendingCell(int row, int col); // Default pending evaluator: evaluates the formula against this sheet
+    void clearPending(int row, int col); // Marks a cell's value as up to date
 
     // Private helper methods
     void updateDependencies(const std::string& cellName, const std::string& formula); // Updates dependencies for a formula
     void recalculateDependents(const std::string& cellName); // Recalculates values of dependent cells
     bool detectCycle(const std::string& startCell, const std::string& currentCell, std::set<std::string>& visited); // Checks for circular dependencies
-    std::string getCellName(int row, int col) const; // Converts a row and column index to a cell name (e.g., A1)
-    void getCellLocation(const std::string& cellName, int& row, int& col) const; // Converts a cell name (e.g., A1) to row and column indices
 
 public:
     int horizontalOffset; // Horizontal scrolling offset for visible cells
     int verticalOffset; // Vertical scrolling offset for visible cells
 
     Spreadsheet(int rows, int cols); // Constructor to initialize a spreadsheet with given rows and columns
-    void display(int visibleRows, int visibleCols, int selectedRow, int selectedCol); // Displays the spreadsheet within the visible range
+    Spreadsheet(Spreadsheet&&) = default; // Moving keeps the graph nodes in the same arena
+    Spreadsheet& operator=(Spreadsheet&&) = delete; // Would free the target's arena while its graph still uses it
+    void display(int visibleRows, int visibleCols, int selectedRow, int selectedCol); // Displays the spreadsheet within the visible range (rows are view positions)
     void setCell(int row, int col, const std::string& value); // Sets the value of a cell and recalculates its dependencies
     double evaluateFormula(const std::string& formula); // Evaluates a formula string and returns the result
+    double evaluateFormula(const std::string& formula, const std::unordered_map<std::string, double>& cellValues); // Evaluates a formula against the given cell values
     void updateCellContent(int row, int col, const std::string& content); // Updates a cell's content and refreshes the display
+    double evaluateFormula(const std::string& formula, const CellValueProvider& cellValues); // Evaluates a formula against a value provider
     void evaluateAllFormulas(); // Recalculates all formulas in the spreadsheet
 
     // File operations
-    std::vector<std::vector<std::string>> exportToData() const; // Exports the spreadsheet data to a 2D vector
+    SheetData exportToData() const; // Exports the spreadsheet data to a 2D vector
     void saveSpreadsheet(const std::string& filename); // Saves the spreadsheet to a file
     void loadSpreadsheet(const std::string& filename); // Loads spreadsheet data from a file
-    void importFromData(const std::vector<std::vector<std::string>>& data); // Imports data into the spreadsheet
+    void importFromData(const SheetData& data); // Imports data into the spreadsheet
     void clear(); // Clears all cells in the spreadsheet
     void resizeGrid(int newRows, int newCols); // Dynamically resizes the grid to accommodate new dimensions
     int getRows() const { return rows; } // Returns the total number of rows in the spreadsheet
     int getCols() const { return cols; } // Returns the total number of columns in the spreadsheet
-    void autoExpandGrid(int currentRow, int currentCol); // Automatically expands the grid when limits are reached
+    void autoExpandGrid(int currentRow, int currentCol); // Automatically expands the grid when limits are reached (only columns while a view is active)
+
+    // Cell access (writes go through the setters so cached range aggregates stay correct)
+    const Cell& getCell(int row, int col) const { return grid[row][col]; } // Returns the cell at the given position
+    void setCellValue(int row, int col, const std::string& value); // Stores raw content without evaluating formulas
+    void setNumericValue(int row, int col, double value); // Stores the computed value of a cell
+    void markCalculating(int row, int col); // Shows a formula as "..." until setNumericValue stores its value
+    bool getValue(const std::string& cellName, double& value); // Looks up a cell's value by name (e.g., A1); false if out of range
+    bool aggregateRange(const std::string& funcName, const std::string& range, double& result); // SUM/AVER/MIN/MAX of a range (e.g., A1..B9) from the cache
+    std::string getCellName(int row, int col) const; // Converts a row and column index to a cell name (e.g., A1)
+    void getCellLocation(const std::string& cellName, int& row, int& col) const; // Converts a cell name (e.g., A1) to row and column indices
+
+    // Sorting and filtering (only the display order changes; cells and formulas stay where they are)
+    void sortRows(const std::vector<SortColumn>& keys, int headerRows = 0); // Stable multi-key sort of the visible rows
+    void filterRows(const std::vector<RowFilter>& filters, int headerRows = 0); // Hides rows that fail any filter
+    void clearView() { view.reset(); } // Shows all rows in their original order again
+    bool isViewActive() const { return view.isActive(); } // Checks if a sort or filter is applied
+    int getViewRowCount() const { return view.size(rows); } // Returns the number of rows in the current view
+    int viewToGridRow(int position) const { return view.gridRow(position); } // Converts a view position to a grid row index
+
+    // Lazy evaluation: pending formulas are evaluated when displayed, when another formula reads them,
+    // or by catch-up passes that work through the rest of the sheet a few cells at a time
+    void setLazyEvaluation(bool on) { lazyEvaluation = on; } // When on, loading marks formulas pending instead of evaluating them
+    bool isLazyEvaluation() const { return lazyEvaluation; } // Checks if loading is lazy
+    void setPendingEvaluator(const std::function<void(int row, int col)>& evaluator) { pendingEvaluator = evaluator; } // Replaces how pending cells are evaluated
+    void markPending(int row, int col); // Marks a formula cell as needing evaluation
+    void ensureEvaluated(int row, int col); // Evaluates a pending cell now (no-op for other cells)
+    void evaluateVisible(const std::vector<int>& gridRows, int firstCol, int colCount); // Evaluates the pending cells of a screen area
+    size_t evaluatePending(size_t maxCells); // Evaluates up to maxCells pending cells; returns how many are still pending
+    size_t getPendingCount() const { return pendingCount; } // Returns the number of pending cells
+
+    // Profiling
+    RecalcProfiler& getProfiler() { return profiler; } // Returns the recalculation profiler
+    RecalcTrace& getTrace() { return trace; } // Returns the evaluation trace (closed unless opened)
+    void printProfile(std::ostream& out, RecalcProfiler::SortKey sortKey, size_t limit = 10) const; // Prints the recalculation profile report
 };
 
 // Converts a column index to its corresponding column name (e.g., 0 -> A, 1 -> B)
@@ -0,0 +1,514 @@
+#include "Workbook.h"
+#include "FileManager.h"
+#include <algorithm>
+#include <iostream>
+#include <queue>
+#include <stack>
+#include <stdexcept>
+#include <cctype>
+
+// Checks whether a word is a valid sheet or range name (letters, digits and underscores, starting with a letter)
+static bool isValidName(const std::string& name) {
+    if (name.empty() || !std::isalpha(name[0])) return false;
+    for (char ch : name) {
+        if (!std::isalnum(ch) && ch != '_') return false;
+    }
+    return true;
+}
+
+// Checks whether a word looks like a cell reference (letters followed by digits, e.g., A1)
+static bool looksLikeCellName(const std::string& word) {
+    size_t i = 0;
+    while (i < word.size() && std::isalpha(word[i])) ++i;
+    if (i == 0 || i == word.size()) return false;
+    while (i < word.size() && std::isdigit(word[i])) ++i;
+    return i == word.size();
+}
+
+// Constructor: Every workbook starts with one sheet
+Workbook::Workbook()
+    : graphArena(new Arena()), dependencyGraph(makeDependencyGraph(*graphArena)),
+      reverseDependencyGraph(makeDependencyGraph(*graphArena)), autoRecalculate(true),
+      lazyEvaluation(false) {
+    addSheet("Sheet1");
+}
+
+std::string Workbook::qualify(const std::string& sheetName, const std::string& cellName) {
+    return sheetName + "!" + cellName;
+}
+
+Spreadsheet& Workbook::addSheet(const std::string& name, int rows, int cols) {
+    // Sheet names end up inside formulas (always followed by '!'), so they must be plain words
+    if (!isValidName(name)) {
+        throw std::invalid_argument("Invalid sheet name: " + name);
+    }
+    if (hasSheet(name)) {
+        throw std::invalid_argument("Sheet already exists: " + name);
+    }
+
+    sheetOrder.push_back(name);
+    Spreadsheet& sheet = sheets.emplace(name, Spreadsheet(rows, cols)).first->second;
+
+    // Pending cells of the sheet are evaluated by the workbook, so they can read other sheets
+    sheet.setPendingEvaluator([this, name](int row, int col) {
+        evaluateCell(qualify(name, sheets.at(name).getCellName(row, col)));
+    });
+    return sheet;
+}
+
+Spreadsheet& Workbook::getSheet(const std::string& name) {
+    auto it = sheets.find(name);
+    if (it == sheets.end()) {
+        throw std::out_of_range("Unknown sheet: " + name);
+    }
+    return it->second;
+}
+
+bool Workbook::hasSheet(const std::string& name) const {
+    return sheets.find(name) != sheets.end();
+}
+
+void Workbook::defineName(const std::string& name, const std::string& reference, const std::string& defaultSheet) {
+    // Names must not be confused with cell references or sheet names inside formulas
+    if (!isValidName(name) || looksLikeCellName(name)) {
+        throw std::invalid_argument("Invalid range name: " + name);
+    }
+    if (reference.empty()) {
+        throw std::invalid_argument("Empty reference for name: " + name);
+    }
+
+    // Store the reference qualified with its sheet so it resolves the same way from every sheet
+    auto previous = namedRanges.find(name);
+    bool hadPrevious = previous != namedRanges.end();
+    std::string oldReference = hadPrevious ? previous->second : std::string();
+    namedRanges[name] = (reference.find('!') == std::string::npos) ? qualify(defaultSheet, reference) : reference;
+
+    // Formulas that already use this name need their dependencies and values refreshed
+    std::set<std::string> changed;
+    for (const auto& sheetName : sheetOrder) {
+        Spreadsheet& sheet = sheets.at(sheetName);
+        for (int r = 0; r < sheet.getRows(); ++r) {
+            for (int c = 0; c < sheet.getCols(); ++c) {
+                const Cell& cell = sheet.getCell(r, c);
+                if (cell.isFormula && cell.value.str().find(name) != std::string::npos) {
+                    std::string cellName = qualify(sheetName, sheet.getCellName(r, c));
+                    updateDependencies(cellName, sheetName, cell.value);
+                    changed.insert(cellName);
+                }
+            }
+        }
+    }
+
+    // The new reference must not make any of these formulas read itself
+    for (const auto& cellName : changed) {
+        std::set<std::string> visited;
+        if (detectCycle(cellName, cellName, visited)) {
+            // Restore the previous name and the dependencies it gave
+            if (hadPrevious) {
+                namedRanges[name] = oldReference;
+            } else {
+                namedRanges.erase(name);
+            }
+            for (const auto& restored : changed) {
+                std::string sheetName;
+                int row, col;
+                if (resolveCell(restored, sheetName, row, col)) {
+                    updateDependencies(restored, sheetName, sheets.at(sheetName).getCell(row, col).value);
+                }
+            }
+            throw std::runtime_error("Circular reference detected!");
+        }
+    }
+
+    recalculate(changed, true);
+}
+
+// Replace every named range in the formula with the reference it stands for
+std::string Workbook::expandNames(const std::string& formula) const {
+    if (namedRanges.empty()) return formula;
+
+    std::string expanded;
+    size_t i = 0;
+    while (i < formula.length()) {
+        if (!std::isalpha(formula[i])) {
+            expanded += formula[i++];
+            continue;
+        }
+
+        // Read the whole word
+        size_t end = i;
+        while (end < formula.length() && (std::isalnum(formula[end]) || formula[end] == '_')) ++end;
+        std::string word = formula.substr(i, end - i);
+
+        // Words followed by '!' are sheet names and words followed by '(' are function names
+        bool isPrefixOrFunction = end < formula.length() && (formula[end] == '!' || formula[end] == '(');
+        auto it = namedRanges.find(word);
+        expanded += (it != namedRanges.end() && !isPrefixOrFunction) ? it->second : word;
+        i = end;
+    }
+    return expanded;
+}
+
+bool Workbook::resolveCell(const std::string& qualifiedName, std::string& sheetName, int& row, int& col) const {
+    auto bang = qualifiedName.find('!');
+    if (bang == std::string::npos) return false;
+
+    sheetName = qualifiedName.substr(0, bang);
+    auto it = sheets.find(sheetName);
+    if (it == sheets.end()) return false;
+
+    try {
+        it->second.getCellLocation(qualifiedName.substr(bang + 1), row, col);
+    } catch (const std::exception&) {
+        return false; // Not a cell name
+    }
+    return row >= 0 && col >= 0 && row < it->second.getRows() && col < it->second.getCols();
+}
+
+double Workbook::evaluateFormula(const std::string& sheetName, const std::string& formula) {
+    // Values are looked up on demand, from whichever sheet they live on
+    return getSheet(sheetName).evaluateFormula(expandNames(formula), SheetValues(*this, sheetName));
+}
+
+bool Workbook::SheetValues::getValue(const std::string& cellRef, double& value) const {
+    std::string qualifiedName = (cellRef.find('!') == std::string::npos) ? qualify(sheetName, cellRef) : cellRef;
+    std::string refSheet;
+    int row, col;
+    if (!workbook.resolveCell(qualifiedName, refSheet, row, col)) return false;
+
+    Spreadsheet& sheet = workbook.sheets.at(refSheet);
+    sheet.ensureEvaluated(row, col);
+    value = sheet.getCell(row, col).numericValue;
+    return true;
+}
+
+bool Workbook::SheetValues::aggregate(const std::string& funcName, const std::string& range, double& result) const {
+    // The sheet prefix of the start cell applies to the whole range (e.g., Sheet2!A1..A5)
+    std::string refSheet = sheetName;
+    std::string cells = range;
+    auto bang = range.find('!');
+    if (bang != std::string::npos && bang < range.find("..")) {
+        refSheet = range.substr(0, bang);
+        cells = range.substr(bang + 1);
+    }
+
+    // Drop a repeated prefix on the end cell (e.g., Sheet2!A1..Sheet2!A5)
+    auto delimiterPos = cells.find("..");
+    auto endBang = cells.find('!', delimiterPos == std::string::npos ? 0 : delimiterPos);
+    if (endBang != std::string::npos && delimiterPos != std::string::npos) {
+        cells = cells.substr(0, delimiterPos + 2) + cells.substr(endBang + 1);
+    }
+
+    auto it = workbook.sheets.find(refSheet);
+    return it != workbook.sheets.end() && it->second.aggregateRange(funcName, cells, result);
+}
+
+void Workbook::updateDependencies(const std::string& qualifiedName, const std::string& sheetName, const std::string& formula) {
+    // Clear old dependencies
+    auto it = dependencyGraph.find(qualifiedName);
+    if (it != dependencyGraph.end()) {
+        for (const auto& dep : it->second) {
+            reverseDependencyGraph[dep].erase(qualifiedName);
+        }
+        dependencyGraph.erase(it);
+    }
+
+    // If the formula is empty or not valid, there is nothing to track
+    if (formula.empty() || formula[0] != '=') return;
+
+    // Extract new dependencies, qualifying references that point to the formula's own sheet
+    for (const auto& ref : parser.extractCellReferences(expandNames(formula))) {
+        std::string dep = (ref.find('!') == std::string::npos) ? qualify(sheetName, ref) : ref;
+        dependencyGraph[qualifiedName].insert(dep);
+        reverseDependencyGraph[dep].insert(qualifiedName);
+    }
+}
+
+bool Workbook::detectCycle(const std::string& startCell, const std::string& currentCell, std::set<std::string>& visited) {
+    if (visited.find(currentCell) != visited.end()) {
+        return currentCell == startCell; // Circular reference detected
+    }
+
+    visited.insert(currentCell);
+
+    // Check all dependencies of the current cell for cycles
+    auto it = dependencyGraph.find(currentCell);
+    if (it != dependencyGraph.end()) {
+        for (const auto& dep : it->second) {
+            if (detectCycle(startCell, dep, visited)) {
+                return true;
+            }
+        }
+    }
+
+    visited.erase(currentCell);
+    return false;
+}
+
+void Workbook::evaluateCell(const std::string& qualifiedName) {
+    std::string sheetName;
+    int row, col;
+    if (!resolveCell(qualifiedName, sheetName, row, col)) return;
+
+    Spreadsheet& sheet = sheets.at(sheetName);
+    const Cell& cell = sheet.getCell(row, col);
+    if (!cell.isFormula) return;
+
+    RecalcProfiler::ScopedTimer timer(profiler, qualifiedName);
+    try {
+        std::string expanded = expandNames(cell.value);
+        sheet.setNumericValue(row, col, trace.evaluate(qualifiedName, expanded, SheetValues(*this, sheetName),
+            [&](const CellValueProvider& values) { return sheet.evaluateFormula(expanded, values); }));
+    } catch (const std::exception& e) {
+        std::string message = "Error evaluating formula in " + qualifiedName + ": " + e.what();
+        if (errorListener) {
+            errorListener(message);
+        } else {
+            std::cerr << message << std::endl;
+        }
+        sheet.setNumericValue(row, col, 0); // Default value in case of an error
+    }
+
+    if (valueListener) {
+        valueListener(sheetName, row, col, cell.numericValue);
+    }
+}
+
+void Workbook::applyValue(const std::string& sheetName, int row, int col, double value) {
+    auto it = sheets.find(sheetName);
+    if (it == sheets.end() || row >= it->second.getRows() || col >= it->second.getCols()) return;
+
+    // Only formulas take computed values; the cell may have been edited since the value was computed
+    if (it->second.getCell(row, col).isFormula) {
+        it->second.setNumericValue(row, col, value);
+    }
+}
+
+std::set<std::string> Workbook::collectAffected(const std::set<std::string>& changedCells, bool includeChanged) const {
+    std::set<std::string> affected;
+    std::stack<std::string> toVisit;
+    for (const auto& cell : changedCells) {
+        if (includeChanged) affected.insert(cell);
+        toVisit.push(cell);
+    }
+    while (!toVisit.empty()) {
+        std::string current = toVisit.top();
+        toVisit.pop();
+
+        auto it = reverseDependencyGraph.find(current);
+        if (it == reverseDependencyGraph.end()) continue;
+        for (const auto& dep : it->second) {
+            if (affected.insert(dep).second) {
+                toVisit.push(dep);
+            }
+        }
+    }
+    return affected;
+}
+
+size_t Workbook::evaluatePending(size_t maxCells) {
+    for (const auto& name : sheetOrder) {
+        Spreadsheet& sheet = sheets.at(name);
+        size_t before = sheet.getPendingCount();
+        if (before > 0 && maxCells > 0) {
+            // Evaluating a cell may also evaluate pending inputs on other sheets, so the budget is
+            // charged with what this sheet actually got through
+            size_t after = sheet.evaluatePending(maxCells);
+            maxCells -= std::min(maxCells, before - after);
+        }
+    }
+    return getPendingCount();
+}
+
+size_t Workbook::getPendingCount() const {
+    size_t pending = 0;
+    for (const auto& entry : sheets) {
+        pending += entry.second.getPendingCount();
+    }
+    return pending;
+}
+
+void Workbook::recalculate(const std::set<std::string>& changedCells, bool includeChanged) {
+    if (!autoRecalculate) {
+        // Values are computed elsewhere (e.g., by a background calculator); until they arrive the
+        // changed formulas show as being calculated, while their dependents keep their old values
+        if (includeChanged) {
+            for (const auto& cell : changedCells) {
+                std::string sheetName;
+                int row, col;
+                if (resolveCell(cell, sheetName, row, col)) sheets.at(sheetName).markCalculating(row, col);
+            }
+        }
+        return;
+    }
+    bool profiling = profiler.isEnabled();
+    std::chrono::steady_clock::time_point recalcStart; // Start time for the profiler
+    if (profiling) recalcStart = std::chrono::steady_clock::now();
+
+    // Collect every cell downstream of the changed cells
+    std::set<std::string> affected = collectAffected(changedCells, includeChanged);
+
+    // Count, for each affected cell, how many of its inputs must be recalculated first
+    std::unordered_map<std::string, int> pendingInputs;
+    std::queue<std::string> ready;
+    for (const auto& cell : affected) {
+        int pending = 0;
+        auto it = dependencyGraph.find(cell);
+        if (it != dependencyGraph.end()) {
+            for (const auto& dep : it->second) {
+                if (dep != cell && affected.count(dep)) ++pending;
+            }
+        }
+        pendingInputs[cell] = pending;
+        if (pending == 0) ready.push(cell);
+    }
+
+    // Evaluate in dependency order so no cell reads a stale input
+    std::set<std::string> evaluated;
+    while (!ready.empty()) {
+        std::string current = ready.front();
+        ready.pop();
+        evaluateCell(current);
+        evaluated.insert(current);
+
+        auto it = reverseDependencyGraph.find(current);
+        if (it == reverseDependencyGraph.end()) continue;
+        for (const auto& dep : it->second) {
+            if (dep != current && affected.count(dep) && --pendingInputs[dep] == 0) {
+                ready.push(dep);
+            }
+        }
+    }
+
+    // Cells caught in a cycle (only possible from loaded files) are evaluated once in any order
+    for (const auto& cell : affected) {
+        if (evaluated.find(cell) == evaluated.end()) {
+            evaluateCell(cell);
+        }
+    }
+
+    if (profiling && !changedCells.empty()) {
+        std::string origin = changedCells.size() == 1 ? *changedCells.begin() : std::to_string(changedCells.size()) + " changed cells";
+        profiler.recordRecalculation(origin, affected.size(), RecalcProfiler::elapsedMicros(recalcStart));
+    }
+}
+
+void Workbook::setCell(const std::string& sheetName, int row, int col, const std::string& value) {
+    Spreadsheet& sheet = getSheet(sheetName);
+
+    // Check if the cell coordinates are within bounds
+    if (row < 0 || col < 0 || row >= sheet.getRows() || col >= sheet.getCols()) {
+        throw std::out_of_range("Invalid cell location.");
+    }
+
+    std::string cellName = qualify(sheetName, sheet.getCellName(row, col));
+    std::string oldValue = sheet.getCell(row, col).value;
+
+    // Check for circular references if the value is a formula
+    updateDependencies(cellName, sheetName, value);
+    if (!value.empty() && value[0] == '=') {
+        std::set<std::string> visited;
+        if (detectCycle(cellName, cellName, visited)) {
+            updateDependencies(cellName, sheetName, oldValue); // Restore the previous dependencies
+            throw std::runtime_error("Circular reference detected!");
+        }
+    }
+
+    // Update the cell value, then evaluate it and everything that depends on it
+    sheet.setCellValue(row, col, value);
+    recalculate({ cellName }, true);
+}
+
+void Workbook::removeSheetDependencies(const std::string& sheetName) {
+    std::string prefix = sheetName + "!";
+    for (auto it = dependencyGraph.begin(); it != dependencyGraph.end();) {
+        if (it->first.compare(0, prefix.size(), prefix) == 0) {
+            for (const auto& dep : it->second) {
+                reverseDependencyGraph[dep].erase(it->first);
+            }
+            it = dependencyGraph.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool Workbook::loadSheet(const std::string& sheetName, const std::string& filename) {
+    FileManager fileManager;
+    SheetData data;
+
+    // Load data from the file (success is reported by the caller, so headless output stays plain CSV)
+    if (!fileManager.loadFromFile(filename, data)) {
+        std::cerr << "Error: Failed to load spreadsheet from " << filename << std::endl;
+        return false;
+    }
+
+    loadSheetData(sheetName, data);
+    return true;
+}
+
+void Workbook::loadSheetData(const std::string& sheetName, const SheetData& data) {
+    Spreadsheet& sheet = getSheet(sheetName);
+    std::string prefix = sheetName + "!";
+
+    // Cells of this sheet that other formulas read must be recalculated after the load
+    std::set<std::string> changed;
+    for (const auto& entry : reverseDependencyGraph) {
+        if (!entry.second.empty() && entry.first.compare(0, prefix.size(), prefix) == 0) {
+            changed.insert(entry.first);
+        }
+    }
+
+    // Replace the sheet contents and rebuild the dependencies of its formulas
+    removeSheetDependencies(sheetName);
+    sheet.clear();
+    sheet.importFromData(data);
+    for (int r = 0; r < sheet.getRows(); ++r) {
+        for (int c = 0; c < sheet.getCols(); ++c) {
+            if (sheet.getCell(r, c).isFormula) {
+                std::string cellName = qualify(sheetName, sheet.getCellName(r, c));
+                updateDependencies(cellName, sheetName, sheet.getCell(r, c).value);
+                changed.insert(cellName);
+            }
+        }
+    }
+
+    // Recalculate the loaded formulas and every cell in other sheets that depends on them,
+    // or only mark them pending so each is evaluated when it is first needed
+    if (lazyEvaluation && autoRecalculate) {
+        for (const auto& cellName : collectAffected(changed, true)) {
+            std::string cellSheet;
+            int row, col;
+            if (resolveCell(cellName, cellSheet, row, col)) {
+                sheets.at(cellSheet).markPending(row, col);
+            }
+        }
+    } else {
+        recalculate(changed, true);
+    }
+
+    // Reset the display offsets to the top-left corner
+    sheet.horizontalOffset = 0;
+    sheet.verticalOffset = 0;
+}
+
+void Workbook::clearSheet(const std::string& sheetName) {
+    Spreadsheet& sheet = getSheet(sheetName);
+    std::string prefix = sheetName + "!";
+
+    // Remember which of this sheet's cells are read by other formulas
+    std::set<std::string> changed;
+    for (const auto& entry : reverseDependencyGraph) {
+        if (!entry.second.empty() && entry.first.compare(0, prefix.size(), prefix) == 0) {
+            changed.insert(entry.first);
+        }
+    }
+
+    removeSheetDependencies(sheetName);
+    sheet.clear();
+    recalculate(changed, false);
+}
+
+void Workbook::printProfile(std::ostream& out, RecalcProfiler::SortKey sortKey, size_t limit) const {
+    profiler.printReport(out, dependencyGraph, sortKey, limit);
+}
@@ -0,0 +1,107 @@
+#ifndef WORKBOOK_H
+#define WORKBOOK_H
+
+#include "Spreadsheet.h"
+#include "DependencyGraph.h"
+#include "FormulaParser.h"
+#include "RecalcProfiler.h"
+#include "RecalcTrace.h"
+#include <functional>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Holds several named spreadsheets that can reference each other (e.g., =Sheet2!A1 * 2)
+// and named ranges (e.g., =SUM(Sales)). All formulas share one dependency graph keyed by
+// qualified cell names ("Sheet1!A1"), so an edit only recalculates the cells that depend on it.
+class Workbook {
+public:
+    // Called with the new value of every formula cell the workbook evaluates
+    typedef std::function<void(const std::string& sheetName, int row, int col, double value)> ValueListener;
+    // Called with the message of every formula that fails to evaluate (instead of printing it)
+    typedef std::function<void(const std::string& message)> ErrorListener;
+
+private:
+    std::map<std::string, Spreadsheet> sheets; // Sheets by name
+    std::vector<std::string> sheetOrder; // Sheet names in the order they were added
+    std::unordered_map<std::string, std::string> namedRanges; // Name -> qualified reference (e.g., Sales -> Sheet1!A1..A5)
+    std::unique_ptr<Arena> graphArena; // Memory for the graph nodes below
+    DependencyGraph dependencyGraph; // Qualified cell -> cells its formula references
+    DependencyGraph reverseDependencyGraph; // Qualified cell -> cells that reference it
+    FormulaParser parser; // Used to extract references from formulas
+    RecalcProfiler profiler; // Records formula evaluation counts and times when enabled
+    RecalcTrace trace; // Logs every formula evaluation while open
+    bool autoRecalculate; // Whether edits recalculate formulas immediately
+    bool lazyEvaluation; // Whether loading leaves formulas pending instead of evaluating them
+    ValueListener valueListener; // Optional observer of evaluated formula values
+    ErrorListener errorListener; // Optional observer of formula errors (printed to std::cerr without one)
+
+    // Supplies the parser with values from any sheet; unqualified references resolve to sheetName
+    class SheetValues : public CellValueProvider {
+    public:
+        SheetValues(Workbook& workbook, const std::string& sheetName) : workbook(workbook), sheetName(sheetName) {}
+        bool getValue(const std::string& cellRef, double& value) const override;
+        bool aggregate(const std::string& funcName, const std::string& range, double& result) const override;
+    private:
+        Workbook& workbook; // Not const: reading a pending cell evaluates it first
+        const std::string& sheetName;
+    };
+
+    // Private helper methods
+    std::string expandNames(const std::string& formula) const; // Replaces named ranges in a formula with their references
+    bool resolveCell(const std::string& qualifiedName, std::string& sheetName, int& row, int& col) const; // Finds the sheet and position of a qualified cell
+    void updateDependencies(const std::string& qualifiedName, const std::string& sheetName, const std::string& formula); // Updates the shared graph for one cell
+    bool detectCycle(const std::string& startCell, const std::string& currentCell, std::set<std::string>& visited); // Checks for circular dependencies
+    void evaluateCell(const std::string& qualifiedName); // Re-evaluates one formula cell
+    std::set<std::string> collectAffected(const std::set<std::string>& changedCells, bool includeChanged) const; // Finds every cell downstream of the changed cells
+    void recalculate(const std::set<std::string>& changedCells, bool includeChanged); // Recalculates everything downstream of the changed cells
+    void removeSheetDependencies(const std::string& sheetName); // Drops all graph edges owned by a sheet's formulas
+
+public:
+    Workbook(); // Creates a workbook with a single sheet named "Sheet1"
+
+    // Sheet management
+    Spreadsheet& addSheet(const std::string& name, int rows = 20, int cols = 20); // Adds an empty sheet
+    Spreadsheet& getSheet(const std::string& name); // Returns a sheet by name (throws if missing)
+    bool hasSheet(const std::string& name) const; // Checks if a sheet exists
+    const std::vector<std::string>& getSheetNames() const { return sheetOrder; } // Returns sheet names in order
+
+    // Named ranges
+    void defineName(const std::string& name, const std::string& reference, const std::string& defaultSheet); // Defines a named cell or range
+    const std::unordered_map<std::string, std::string>& getNames() const { return namedRanges; } // Returns all named ranges
+
+    // Cell operations
+    void setCell(const std::string& sheetName, int row, int col, const std::string& value); // Sets a cell and recalculates its dependents in all sheets
+    double evaluateFormula(const std::string& sheetName, const std::string& formula); // Evaluates a formula in the context of a sheet
+
+    // Recalculation control
+    void setAutoRecalculate(bool on) { autoRecalculate = on; } // When off, edits only update values and dependencies (edited formulas show "...")
+    void setValueListener(const ValueListener& listener) { valueListener = listener; } // Observes every evaluated formula value
+    void setErrorListener(const ErrorListener& listener) { errorListener = listener; } // Observes every formula error
+    void applyValue(const std::string& sheetName, int row, int col, double value); // Stores a value computed elsewhere in a formula cell
+
+    // Lazy evaluation: loaded formulas and the cells that depend on them are only evaluated when
+    // displayed or read by another formula, or by catch-up passes (see Spreadsheet)
+    void setLazyEvaluation(bool on) { lazyEvaluation = on; } // When on, loading marks formulas pending instead of evaluating them
+    size_t evaluatePending(size_t maxCells); // Evaluates up to maxCells pending cells; returns how many are still pending
+    size_t getPendingCount() const; // Returns the number of pending cells in all sheets
+
+    // File operations
+    bool loadSheet(const std::string& sheetName, const std::string& filename); // Loads a CSV into a sheet and recalculates; false if the file cannot be read
+    void loadSheetData(const std::string& sheetName, const SheetData& data); // Replaces a sheet's contents and recalculates
+    void clearSheet(const std::string& sheetName); // Clears a sheet and recalculates cells that referenced it
+
+    // Profiling
+    RecalcProfiler& getProfiler() { return profiler; } // Returns the recalculation profiler
+    RecalcTrace& getTrace() { return trace; } // Returns the evaluation trace (closed unless opened)
+    void printProfile(std::ostream& out, RecalcProfiler::SortKey sortKey, size_t limit = 10) const; // Prints the recalculation profile report
+
+    // Builds a qualified cell name (e.g., "Sheet1", "A1" -> "Sheet1!A1")
+    static std::string qualify(const std::string& sheetName, const std::string& cellName);
+};
+
+#endif // WORKBOOK_H
@@ -1,14 +1,110 @@
 #include "Spreadsheet.h"
+#include "Workbook.h"
+#include "BackgroundCalculator.h"
+#include "AutoSaver.h"
 #include "AnsiTerminal.h"
 #include "FileManager.h"
+#include <algorithm>
 #include <iostream>
+#include <string>
+#include <vector>
+
+// Runs without the terminal UI: loads a file, prints its evaluated values and optionally a profile report
+// Usage: spreadsheet --headless <file.csv> [--profile [time|count|avg|name]] [--top N] [--trace <trace.bin>]
+static int runHeadless(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " --headless <file.csv> [--profile [time|count|avg|name]] [--top N] [--trace <trace.bin>]" << std::endl;
+        return 1;
+    }
+
+    std::string filename = argv[2];
+    bool profile = false;
+    std::string sortKey = "time";
+    size_t top = 10;
+    std::string traceFile;
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--profile") {
+            profile = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') sortKey = argv[++i]; // Optional sort column
+        } else if (arg == "--top" && i + 1 < argc) {
+            top = std::stoul(argv[++i]);
+        } else if (arg == "--trace" && i + 1 < argc) {
+            traceFile = argv[++i];
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    Workbook workbook;
+    const std::string sheetName = workbook.getSheetNames().front();
+    workbook.getProfiler().setEnabled(profile);
+    if (!traceFile.empty() && !workbook.getTrace().open(traceFile)) {
+        std::cerr << "Error: Could not create trace file " << traceFile << std::endl;
+        return 1;
+    }
+    bool loaded = workbook.loadSheet(sheetName, filename);
+    workbook.getTrace().close();
+    if (!loaded) return 1;
+
+    // Print the evaluated values as CSV
+    Spreadsheet& sheet = workbook.getSheet(sheetName);
+    for (int r = 0; r < sheet.getRows(); ++r) {
+        for (int c = 0; c < sheet.getCols(); ++c) {
+            std::cout << sheet.getCell(r, c).getDisplayValue() << (c + 1 < sheet.getCols() ? "," : "");
+        }
+        std::cout << "\n";
+    }
+
+    if (profile) {
+        workbook.printProfile(std::cout, RecalcProfiler::parseSortKey(sortKey), top);
+    }
+    return 0;
+}
+
+// Re-evaluates a recorded trace with the current formula engine and reports every difference
+// Usage: spreadsheet --replay <trace.bin> [--tolerance X]
+static int runReplay(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " --replay <trace.bin> [--tolerance X]" << std::endl;
+        return 1;
+    }
+
+    double tolerance = 1e-9;
+    if (argc > 4 && std::string(argv[3]) == "--tolerance") {
+        tolerance = std::stod(argv[4]);
+    }
+
+    std::vector<RecalcTrace::Record> records;
+    if (!RecalcTrace::read(argv[2], records)) {
+        std::cerr << "Error: Could not read trace file " << argv[2] << std::endl;
+        return 1;
+    }
+    return RecalcTrace::replay(records, std::cout, tolerance) == 0 ? 0 : 2;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--headless") {
+        return runHeadless(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--replay") {
+        return runReplay(argc, argv);
+    }
 
-int main() {
     const int visibleRows = 10; // Fixed number of visible rows on the screen
     const int visibleCols = 10; // Fixed number of visible columns on the screen
 
-    int defaultRows = 20, defaultCols = 20; // Default grid size for the spreadsheet
-    Spreadsheet sheet(defaultRows, defaultCols);
+    Workbook workbook; // Workbook holding all sheets (starts with "Sheet1"); shows the last finished values
+    workbook.setAutoRecalculate(false); // Formulas are recalculated by the background calculator instead
+    BackgroundCalculator calculator; // Recalculates formulas on a worker thread
+    if (argc > 2 && std::string(argv[1]) == "--trace" && !calculator.startTrace(argv[2])) {
+        std::cerr << "Error: Could not create trace file " << argv[2] << std::endl; // Interactive session is recorded for --replay
+        return 1;
+    }
+    AutoSaver saver; // Saves files on a worker thread and makes periodic backups
+    std::string currentSheet = workbook.getSheetNames().front(); // Name of the sheet being edited
+    std::string statusMessage; // Result of the last background save or calculation error, shown under the grid
     FileManager fileManager;
 
     AnsiTerminal terminal; // Terminal object for handling screen output and input
@@ -17,14 +113,55 @@ int main() {
     int row = 0, col = 0; // Initial cursor position
     std::string currentFile = "untitled.csv"; // Default filename for the spreadsheet
 
-    while (true) {
+    // Redraws the screen with the latest finished values and the background work indicators
+    auto redraw = [&]() {
+        calculator.applyResults(workbook);
+        std::string saveStatus = saver.takeStatus();
+        if (!saveStatus.empty()) statusMessage = saveStatus;
+        std::vector<std::string> errors = calculator.takeErrors(); // Reported here: the worker never writes to the screen
+        if (!errors.empty()) {
+            statusMessage = errors.back();
+            if (errors.size() > 1) statusMessage += " (+" + std::to_string(errors.size() - 1) + " more errors)";
+        }
+
         terminal.clearScreen();
-        sheet.display(visibleRows, visibleCols, row, col); // Display the spreadsheet
+        Spreadsheet& shown = workbook.getSheet(currentSheet);
+        shown.display(visibleRows, visibleCols, row, col); // Display the spreadsheet
+
+        // Tell the calculator which cells are on screen, so pending formulas there are evaluated first
+        std::vector<int> shownRows;
+        for (int pos = shown.verticalOffset; pos < std::min(shown.verticalOffset + visibleRows, shown.getViewRowCount()); ++pos) {
+            shownRows.push_back(shown.viewToGridRow(pos));
+        }
+        calculator.setViewport(currentSheet, shownRows, shown.horizontalOffset, visibleCols);
 
         // Instructions for the user
-        std::cout << "\nCommands: [U/D/L/R] Move, [e] Edit Cell, [s] Save, [l] Load, [n] New File, [a] Save As, [q] Quit\n";
+        std::cout << "\nSheet: " << currentSheet;
+        if (calculator.isBusy()) std::cout << "  [calculating...]";
+        if (saver.isBusy()) std::cout << "  [saving...]";
+        if (!statusMessage.empty()) std::cout << "  " << statusMessage;
+        std::cout << "\n";
+        std::cout << "Commands: [U/D/L/R] Move, [e] Edit Cell, [s] Save, [l] Load, [n] New File, [a] Save As, [w] Switch Sheet, [m] Name Range, [o] Sort, [f] Filter, [p] Profile, [q] Quit\n";
+    };
+
+    while (true) {
+        const std::string shownSheet = currentSheet; // Sheet shown when the command was given
+        Spreadsheet& sheet = workbook.getSheet(currentSheet); // Sheet currently shown on screen
+        int sheetRows = sheet.getRows(), sheetCols = sheet.getCols(); // Size before this command, to detect grid expansion
+
+        // Back up unsaved edits in the background once the autosave interval has passed
+        if (saver.autosaveDue()) {
+            saver.autosave(currentFile, sheet.exportToData());
+        }
+
+        // Keep refreshing while background work runs so finished values appear without a key press
+        redraw();
+        while ((calculator.isBusy() || saver.isBusy()) && !terminal.waitForInput(200)) {
+            redraw();
+        }
 
         char key = terminal.getSpecialKey(); // Get the user's command input
+        statusMessage.clear();
 
         switch (key) {
             case 'U': { // Move cursor up
@@ -35,11 +172,13 @@ int main() {
                 break;
             }
             case 'D': { // Move cursor down
-                row = (row < sheet.getRows() - 1) ? row + 1 : row; // Prevent moving below the last row
+                row = (row < sheet.getViewRowCount() - 1) ? row + 1 : row; // Prevent moving below the last row
                 if (row >= sheet.verticalOffset + visibleRows) {
                     sheet.verticalOffset++; // Adjust vertical offset if needed
                 }
-                sheet.autoExpandGrid(row, col); // Automatically expand grid if needed
+                if (!sheet.isViewActive()) {
+                    sheet.autoExpandGrid(row, col); // Automatically expand grid if needed (not while sorted or filtered)
+                }
                 break;
             }
             case 'R': { // Move cursor right
@@ -47,7 +186,7 @@ int main() {
                 if (col >= sheet.horizontalOffset + visibleCols) {
                     sheet.horizontalOffset++; // Adjust horizontal offset if needed
                 }
-                sheet.autoExpandGrid(row, col); // Automatically expand grid if needed
+                sheet.autoExpandGrid(sheet.viewToGridRow(row), col); // Automatically expand grid if needed (only columns while sorted or filtered)
                 break;
             }
             case 'L': { // Move cursor left
@@ -60,24 +199,22 @@ int main() {
             case 'e': { // Edit a cell
                 terminal.clearScreen();
                 sheet.display(visibleRows, visibleCols, row, col); // Redisplay the spreadsheet
-                std::cout << "Enter value for cell " << columnName(col) << (row + 1) << ": ";
+                int gridRow = sheet.viewToGridRow(row); // The cursor row is a position in the (possibly sorted) view
+                std::cout << "Enter value for cell " << columnName(col) << (gridRow + 1) << ": ";
                 std::string input = terminal.getInputWithEditing(); // Get the new value for the cell
 
                 try {
-                    sheet.setCell(row, col, input); // Update the cell with the input value
+                    workbook.setCell(currentSheet, gridRow, col, input); // Update the cell and check for circular references
+                    calculator.setCell(currentSheet, gridRow, col, input); // Recalculate it and its dependents in the background
+                    saver.markDirty();
                 } catch (const std::exception& e) {
                     std::cerr << "Error: " << e.what() << std::endl;
                     terminal.getKeystroke(); // Wait for user input before continuing
                 }
                 break;
             }
-            case 's': { // Save the current spreadsheet
-                if (!fileManager.saveToFile(currentFile, sheet.exportToData())) {
-                    std::cerr << "Failed to save file: " << currentFile << std::endl;
-                } else {
-                    std::cout << "Spreadsheet saved to " << currentFile << std::endl;
-                    terminal.getKeystroke();
-                }
+            case 's': { // Save the current spreadsheet in the background
+                saver.save(currentFile, sheet.exportToData());
                 break;
             }
             case 'l': { // Load a spreadsheet from a file
@@ -85,8 +222,17 @@ int main() {
                 std::string filename = terminal.getInputWithEditing();
 
                 try {
-                    sheet.loadSpreadsheet(filename); // Load the spreadsheet data
-                    currentFile = filename; // Update the current file name
+                    SheetData data;
+                    if (fileManager.loadFromFile(filename, data)) {
+                        workbook.loadSheetData(currentSheet, data); // Show the loaded contents right away
+                        calculator.loadSheetData(currentSheet, data); // Evaluate its formulas in the background
+                        currentFile = filename; // Update the current file name
+                        row = 0;
+                        col = 0;
+                        std::cout << "Spreadsheet loaded" << std::endl;
+                    } else {
+                        std::cerr << "Error: Failed to load spreadsheet from " << filename << std::endl;
+                    }
                 } catch (const std::exception& e) {
                     std::cerr << "Error: " << e.what() << std::endl;
                 }
@@ -98,7 +244,8 @@ int main() {
                 std::cout << "Enter new filename: ";
                 std::string filename = terminal.getInputWithEditing();
                 if (fileManager.createNewFile(filename)) {
-                    sheet.clear(); // Clear the current spreadsheet
+                    workbook.clearSheet(currentSheet); // Clear the current spreadsheet
+                    calculator.clearSheet(currentSheet);
                     currentFile = filename; // Update the current file name
                     std::cout << "New file created: " << filename << std::endl;
                 } else {
@@ -111,11 +258,96 @@ int main() {
                 std::cout << "Enter new filename to save as: ";
                 std::string filename = terminal.getInputWithEditing();
 
-                if (fileManager.saveAs(filename, sheet.exportToData())) {
-                    currentFile = filename; // Update the current file name
-                    std::cout << "Spreadsheet saved as " << filename << std::endl;
+                saver.save(filename, sheet.exportToData());
+                currentFile = filename; // Update the current file name
+                break;
+            }
+            case 'w': { // Switch to another sheet, creating it if it does not exist
+                std::cout << "Enter sheet name: ";
+                std::string name = terminal.getInputWithEditing();
+
+                try {
+                    if (!workbook.hasSheet(name)) {
+                        Spreadsheet& added = workbook.addSheet(name);
+                        calculator.addSheet(name, added.getRows(), added.getCols());
+                    }
+                    currentSheet = name;
+                    row = 0; // Start at the top-left corner of the sheet
+                    col = 0;
+                    workbook.getSheet(name).horizontalOffset = 0;
+                    workbook.getSheet(name).verticalOffset = 0;
+                } catch (const std::exception& e) {
+                    std::cerr << "Error: " << e.what() << std::endl;
+                    terminal.getKeystroke();
+                }
+                break;
+            }
+            case 'm': { // Define a named range (e.g., Sales = A1..A5 or Sheet2!B1..B9)
+                std::cout << "Enter range name: ";
+                std::string name = terminal.getInputWithEditing();
+                std::cout << "Enter reference for " << name << ": ";
+                std::string reference = terminal.getInputWithEditing();
+
+                try {
+                    workbook.defineName(name, reference, currentSheet);
+                    calculator.defineName(name, reference, currentSheet);
+                } catch (const std::exception& e) {
+                    std::cerr << "Error: " << e.what() << std::endl;
+                    terminal.getKeystroke();
+                }
+                break;
+            }
+            case 'o': { // Sort rows by one or more columns (display order only)
+                std::cout << "Sort by columns (e.g., A,-C for A ascending then C descending): ";
+                std::string spec = terminal.getInputWithEditing();
+                std::cout << "Keep the first row as a header? (y/n): ";
+                std::string header = terminal.getInputWithEditing();
+
+                try {
+                    sheet.sortRows(RowView::parseSortSpec(spec), header == "y" ? 1 : 0);
+                    row = 0;
+                    sheet.verticalOffset = 0;
+                } catch (const std::exception& e) {
+                    std::cerr << "Error: " << e.what() << std::endl;
+                    terminal.getKeystroke();
+                }
+                break;
+            }
+            case 'f': { // Filter rows (empty input shows all rows in their original order again)
+                std::cout << "Filter (e.g., B > 10, C contains abc; empty clears sort and filter): ";
+                std::string spec = terminal.getInputWithEditing();
+
+                try {
+                    if (spec.empty()) {
+                        sheet.clearView();
+                    } else {
+                        std::cout << "Keep the first row as a header? (y/n): ";
+                        std::string header = terminal.getInputWithEditing();
+                        sheet.filterRows(RowView::parseFilterSpec(spec), header == "y" ? 1 : 0);
+                    }
+                    row = 0;
+                    sheet.verticalOffset = 0;
+                } catch (const std::exception& e) {
+                    std::cerr << "Error: " << e.what() << std::endl;
+                    terminal.getKeystroke();
+                }
+                break;
+            }
+            case 'p': { // Show the recalculation profile (the first press starts profiling)
+                // Formulas are evaluated by the background calculator, so its model holds the profile
+                if (!calculator.isProfiling()) {
+                    calculator.setProfiling(true);
+                    std::cout << "Profiling started. Edit or load cells, then press [p] again for the report." << std::endl;
                 } else {
-                    std::cerr << "Failed to save file as: " << filename << std::endl;
+                    std::cout << "Sort by [t]ime, [c]ount, [a]verage or [n]ame (or [r] to reset): ";
+                    std::string choice = terminal.getInputWithEditing();
+                    if (choice == "r") {
+                        calculator.resetProfile();
+                        std::cout << "Profile data cleared." << std::endl;
+                    } else {
+                        terminal.clearScreen();
+                        calculator.printProfile(std::cout, RecalcProfiler::parseSortKey(choice));
+                    }
                 }
                 terminal.getKeystroke();
                 break;
@@ -126,5 +358,10 @@ int main() {
                 return 0;
             }
         }
+
+        // Keep the calculator's copy of the sheet as large as the displayed one
+        if (sheet.getRows() != sheetRows || sheet.getCols() != sheetCols) {
+            calculator.resizeSheet(shownSheet, sheet.getRows(), sheet.getCols());
+        }
     }
 }
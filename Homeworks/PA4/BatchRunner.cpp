@@ -0,0 +1,152 @@
+#include "BatchRunner.h"
+#include "World.h"
+#include "Checkpoint.h"
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// =====================
+// BatchSettings / BatchSummary Implementation
+// =====================
+
+BatchSettings::BatchSettings()
+    : width(10), height(10), robotsPerType(5), games(1000), maxSteps(100000), threads(0),
+      seed(static_cast<uint64_t>(time(nullptr))), start(nullptr) {
+}
+
+BatchSummary::BatchSummary()
+    : games(0), draws(0), unfinished(0), minSteps(0), maxSteps(0), seconds(0), threads(0), seed(0) {
+    for (int type = 0; type < ROBOT_TYPE_COUNT; type++) {
+        wins[type] = 0;
+        survivors[type] = 0;
+        survivorSteps[type] = 0;
+    }
+}
+
+void BatchSummary::add(const BatchSummary& other) {
+    if (other.games == 0) {
+        return;
+    }
+    minSteps = (games == 0) ? other.minSteps : min(minSteps, other.minSteps);
+    maxSteps = max(maxSteps, other.maxSteps);
+    games += other.games;
+    draws += other.draws;
+    unfinished += other.unfinished;
+    for (int type = 0; type < ROBOT_TYPE_COUNT; type++) {
+        wins[type] += other.wins[type];
+        survivors[type] += other.survivors[type];
+        survivorSteps[type] += other.survivorSteps[type];
+    }
+    counters.add(other.counters);
+}
+
+void BatchSummary::print(ostream& out) const {
+    out << "Games: " << games << " (seed " << seed << ", " << threads << " threads, " << seconds << " s, "
+        << (seconds > 0 ? games / seconds : 0) << " games/s)" << "\n";
+    out << "Steps per game: " << (games > 0 ? static_cast<double>(counters.steps) / games : 0)
+        << " average, " << minSteps << " min, " << maxSteps << " max" << "\n";
+
+    // Win rates and survival times, one line per robot type
+    out << left << setw(14) << "type" << right << setw(12) << "wins" << setw(10) << "win %"
+        << setw(16) << "avg survival" << "\n";
+    for (int type = 0; type < ROBOT_TYPE_COUNT; type++) {
+        long long robots = counters.destroyed[type] + survivors[type];
+        double survival = robots > 0 ? static_cast<double>(counters.lifetimeSteps[type] + survivorSteps[type]) / robots : 0;
+        out << left << setw(14) << ROBOT_TYPES[type].name << right << setw(12) << wins[type]
+            << setw(10) << fixed << setprecision(2) << (games > 0 ? 100.0 * wins[type] / games : 0)
+            << setw(16) << survival << "\n";
+        out.unsetf(ios::fixed);
+        out << setprecision(6);
+    }
+    out << "Draws: " << draws << ", unfinished: " << unfinished << "\n";
+}
+
+// =====================
+// BatchRunner Implementation
+// =====================
+
+BatchRunner::BatchRunner(const BatchSettings& newSettings) : settings(newSettings) {
+}
+
+void BatchRunner::runGame(uint64_t seed, BatchSummary& summary) const {
+    World world(settings.width, settings.height);
+    if (settings.start != nullptr) {
+        world.loadCheckpoint(*settings.start);
+        world.setSeed(seed);
+        world.setSpawnSettings(settings.spawning);
+    } else {
+        world.setSeed(seed);
+        world.setSpawnSettings(settings.spawning);
+        world.initialize(vector<int>(ROBOT_TYPE_COUNT, settings.robotsPerType));
+    }
+
+    EventCounters counters;
+    world.setEventCounters(&counters);
+    long long firstStep = world.getStepCount();
+    bool running = world.getRobotCount() > 1;
+    while (running && (settings.maxSteps == 0 || world.getStepCount() - firstStep < settings.maxSteps)) {
+        running = world.simulateFastStep();
+    }
+
+    // Result of the game
+    long long steps = world.getStepCount() - firstStep;
+    summary.minSteps = (summary.games == 0) ? steps : min(summary.minSteps, steps);
+    summary.maxSteps = max(summary.maxSteps, steps);
+    summary.games++;
+    if (world.getRobotCount() == 0) {
+        summary.draws++;
+    } else if (world.getRobotCount() == 1) {
+        summary.wins[world.getStore().type[world.findSurvivor()]]++;
+    } else {
+        summary.unfinished++;
+    }
+
+    // Robots still alive lived until the end of the game
+    const RobotStore& store = world.getStore();
+    for (int slot = 0; slot < store.getSlotCount(); slot++) {
+        if (store.active[slot]) {
+            summary.survivors[store.type[slot]]++;
+            summary.survivorSteps[store.type[slot]] += world.getStepCount() - store.bornStep[slot];
+        }
+    }
+    summary.counters.add(counters);
+}
+
+void BatchRunner::runShare(int thread, int threadCount, BatchSummary& summary) const {
+    for (long long game = thread; game < settings.games; game += threadCount) {
+        runGame(settings.seed + static_cast<uint64_t>(game), summary);
+    }
+}
+
+BatchSummary BatchRunner::run() const {
+    int threadCount = settings.threads;
+    if (threadCount <= 0) {
+        threadCount = max(1, static_cast<int>(thread::hardware_concurrency()));
+    }
+
+    // Each thread fills its own summary; they are merged once all threads have finished
+    auto start = chrono::steady_clock::now();
+    vector<BatchSummary> shares(threadCount);
+    vector<thread> workers;
+    for (int i = 1; i < threadCount; i++) {
+        workers.push_back(thread(&BatchRunner::runShare, this, i, threadCount, ref(shares[i])));
+    }
+    runShare(0, threadCount, shares[0]);
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+
+    BatchSummary summary;
+    for (int i = 0; i < threadCount; i++) {
+        summary.add(shares[i]);
+    }
+    summary.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    summary.threads = threadCount;
+    summary.seed = settings.seed;
+    return summary;
+}
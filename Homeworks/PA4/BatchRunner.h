@@ -0,0 +1,67 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include "EventCounters.h"
+#include "RobotStore.h"
+#include "SpawnSettings.h"
+#include <cstdint>
+#include <ostream>
+
+class Checkpoint;
+
+/**
+ * Settings of a batch of independent simulations
+ */
+struct BatchSettings {
+    int width, height;          // World size
+    int robotsPerType;          // Initial robots of each type
+    long long games;            // Number of simulations to run
+    long long maxSteps;         // Steps after which a simulation is abandoned (0: no limit)
+    int threads;                // Worker threads (0: one per core)
+    uint64_t seed;              // Seed of the first simulation; simulation i uses seed + i
+    SpawnSettings spawning;     // Robots added during each simulation (default: none)
+    const Checkpoint* start;    // World every simulation branches from, with its own seed (nullptr: a new world)
+
+    BatchSettings();
+};
+
+/**
+ * Totals over a batch of simulations
+ */
+struct BatchSummary {
+    long long games;                           // Simulations run
+    long long wins[ROBOT_TYPE_COUNT];          // Simulations won, by type of the last robot
+    long long draws;                           // Simulations in which the last robots destroyed each other
+    long long unfinished;                      // Simulations stopped at the step limit (every one, with continuous spawning)
+    long long minSteps, maxSteps;              // Shortest and longest simulation
+    long long survivors[ROBOT_TYPE_COUNT];     // Robots still alive at the end, by type
+    long long survivorSteps[ROBOT_TYPE_COUNT]; // Steps lived by those robots, by type
+    EventCounters counters;                    // Events of all simulations
+    double seconds;                            // Wall-clock time of the batch
+    int threads;                               // Worker threads used
+    uint64_t seed;                             // Seed of the first simulation
+
+    BatchSummary();
+    void add(const BatchSummary& other);       // Merge the totals of another part of the batch
+    void print(std::ostream& out) const;       // Print win rates, survival times and step counts
+};
+
+/**
+ * Runs many independent World simulations (headless fast steps) on all cores
+ * Every simulation has its own World and random number generator, so threads
+ * share nothing until their totals are merged at the end, and the results only
+ * depend on the seed, not on the number of threads.
+ */
+class BatchRunner {
+private:
+    BatchSettings settings;
+
+    void runGame(uint64_t seed, BatchSummary& summary) const;           // Run one simulation and add it to summary
+    void runShare(int thread, int threadCount, BatchSummary& summary) const; // Run every threadCount-th simulation
+
+public:
+    explicit BatchRunner(const BatchSettings& newSettings);
+    BatchSummary run() const;                  // Run the whole batch and return its totals
+};
+
+#endif // BATCHRUNNER_H
@@ -0,0 +1,187 @@
+#include "BattleLog.h"
+#include "RobotStore.h"
+#include <cstring>
+
+using namespace std;
+
+// Start of every battle log file
+struct BattleLogHeader {
+    char magic[8];              // "ROBOLOG1"
+    uint32_t recordSize;        // sizeof(BattleEvent), to catch logs written by another layout
+    uint32_t reserved;
+};
+
+static const char BATTLE_LOG_MAGIC[8] = { 'R', 'O', 'B', 'O', 'L', 'O', 'G', '1' };
+
+// =====================
+// BattleLogWriter Class Implementation
+// =====================
+
+BattleLogWriter::BattleLogWriter() : file(nullptr), recordCount(0), failed(false) {
+    buffer.reserve(BUFFER_RECORDS);
+}
+
+BattleLogWriter::~BattleLogWriter() {
+    close();
+}
+
+bool BattleLogWriter::open(const string& path) {
+    close();
+    file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    BattleLogHeader header;
+    memcpy(header.magic, BATTLE_LOG_MAGIC, sizeof(header.magic));
+    header.recordSize = sizeof(BattleEvent);
+    header.reserved = 0;
+    recordCount = 0;
+    failed = fwrite(&header, sizeof(header), 1, file) != 1;
+    return !failed;
+}
+
+void BattleLogWriter::write(const BattleEvent& event) {
+    if (buffer.size() == BUFFER_RECORDS) {
+        flush();
+    }
+    buffer.push_back(event);
+    recordCount++;
+}
+
+void BattleLogWriter::write(const BattleEvent* events, size_t count) {
+    if (buffer.size() + count > BUFFER_RECORDS) {
+        flush();
+    }
+    if (count >= BUFFER_RECORDS) {
+        // Too many to be worth copying: straight to the file
+        if (file != nullptr && fwrite(events, sizeof(BattleEvent), count, file) != count) {
+            failed = true;
+        }
+    } else {
+        buffer.insert(buffer.end(), events, events + count);
+    }
+    recordCount += count;
+}
+
+void BattleLogWriter::flush() {
+    if (file != nullptr && !buffer.empty() &&
+        fwrite(buffer.data(), sizeof(BattleEvent), buffer.size(), file) != buffer.size()) {
+        failed = true;
+    }
+    buffer.clear();
+}
+
+bool BattleLogWriter::close() {
+    if (file == nullptr) {
+        return !failed;
+    }
+    flush();
+    if (fclose(file) != 0) {
+        failed = true;
+    }
+    file = nullptr;
+    return !failed;
+}
+
+long long BattleLogWriter::getRecordCount() const {
+    return recordCount;
+}
+
+// =====================
+// BattleLogReader Class Implementation
+// =====================
+
+BattleLogReader::BattleLogReader() : file(nullptr), position(0) {
+}
+
+BattleLogReader::~BattleLogReader() {
+    if (file != nullptr) {
+        fclose(file);
+    }
+}
+
+bool BattleLogReader::open(const string& path) {
+    file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    BattleLogHeader header;
+    return fread(&header, sizeof(header), 1, file) == 1 &&
+           memcmp(header.magic, BATTLE_LOG_MAGIC, sizeof(header.magic)) == 0 &&
+           header.recordSize == sizeof(BattleEvent);
+}
+
+bool BattleLogReader::read(BattleEvent& event) {
+    if (position == buffer.size()) {
+        if (file == nullptr) {
+            return false;
+        }
+        // Refill the buffer with the next block of records
+        buffer.resize(BUFFER_RECORDS);
+        buffer.resize(fread(buffer.data(), sizeof(BattleEvent), buffer.size(), file));
+        position = 0;
+        if (buffer.empty()) {
+            return false;
+        }
+    }
+    event = buffer[position++];
+    return true;
+}
+
+// =====================
+// Rendering
+// =====================
+
+static string robotName(int type, int sequence) {
+    return string(ROBOT_TYPES[type].name) + "_" + to_string(sequence);
+}
+
+// The lines World::fight, printHitMessage and the getDamage overrides print for each record
+void renderBattleEvent(const BattleEvent& event, ostream& out) {
+    if (event.attackerType >= ROBOT_TYPE_COUNT || event.defenderType >= ROBOT_TYPE_COUNT) {
+        out << "(damaged record)" << "\n";
+        return;
+    }
+    string attacker = robotName(event.attackerType, event.attacker);
+    string defender = robotName(event.defenderType, event.defender);
+    const char* attackerType = ROBOT_TYPES[event.attackerType].name;
+
+    switch (event.kind) {
+        case BATTLE_STEP:
+            out << "===== Step " << event.step << " =====" << "\n";
+            break;
+        case BATTLE_FIGHT_BEGIN:
+            out << "\n=== FIGHT BEGINS ===" << "\n";
+            out << attacker << " (" << attackerType << ") vs. "
+                << defender << " (" << ROBOT_TYPES[event.defenderType].name << ")" << "\n";
+            break;
+        case BATTLE_HIT:
+            // How the damage was made up
+            if (event.attackerType == KAMIKAZE) {
+                out << attacker << " performs a KAMIKAZE attack for " << event.damage << " points!" << "\n";
+            } else {
+                out << attackerType << " attacks for " << event.firstDamage << " points!" << "\n";
+            }
+            if (event.flags & BATTLE_TACTICAL_NUKE) {
+                out << "Humanic robot " << attacker << " inflicts a TACTICAL NUKE attack!" << "\n";
+            }
+            if (event.flags & BATTLE_STRONG_ATTACK) {
+                out << "OptimusPrime " << attacker << " inflicts a STRONG attack, doubling damage!" << "\n";
+            }
+            if (event.attackerType == ROOMBA) {
+                out << attacker << " attacks again as it's very fast!" << "\n";
+                out << attackerType << " attacks for " << event.secondDamage << " more points!" << "\n";
+            }
+
+            out << attacker << "(" << event.attackerHitpoints << ") hits " << defender << "("
+                << event.defenderHitpointsBefore << ") with " << event.damage << "\n";
+            out << "The new hitpoints of " << defender << " is " << event.defenderHitpoints << "\n";
+            if (event.flags & BATTLE_DESTROYED) {
+                out << defender << " has been destroyed!" << "\n";
+            }
+            break;
+        case BATTLE_FIGHT_END:
+            out << "=== FIGHT ENDS ===" << "\n";
+            break;
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef BATTLELOG_H
+#define BATTLELOG_H
+
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Kind of a battle log record
+enum BattleEventKind {
+    BATTLE_STEP,          // A simulation step starts
+    BATTLE_FIGHT_BEGIN,   // Attacker runs into defender
+    BATTLE_HIT,           // Attacker hits defender (for a counter-attack, the record's attacker is the fight's defender)
+    BATTLE_FIGHT_END      // One of the two robots died
+};
+
+// Bits of BattleEvent::flags
+enum BattleEventFlag {
+    BATTLE_TACTICAL_NUKE = 1,   // Humanic +40 damage
+    BATTLE_STRONG_ATTACK = 2,   // OptimusPrime double damage
+    BATTLE_DESTROYED = 4        // The robot hit has no hitpoints left
+};
+
+/**
+ * One fixed-size record of a battle log
+ * Robots are identified by type and name number (kamikaze_3 is KAMIKAZE, 3).
+ * A hit keeps every roll of the attack, so the log can be rendered as the exact
+ * text World::fight prints.
+ */
+struct BattleEvent {
+    uint8_t kind;               // BattleEventKind
+    uint8_t flags;              // BattleEventFlag bits (hits only)
+    uint8_t attackerType;       // RobotType of the attacker (fights and hits)
+    uint8_t defenderType;       // RobotType of the defender (fights and hits)
+    int32_t step;               // Simulation step
+    int32_t attacker;           // Name number of the attacker
+    int32_t defender;           // Name number of the defender
+    int32_t damage;             // Total damage of the hit
+    int32_t firstDamage;        // First roll of the hit (before a nuke or doubling)
+    int32_t secondDamage;       // Roll of a roomba's second attack
+    int32_t attackerHitpoints;  // Hitpoints of the attacker after hitting (0 for a kamikaze)
+    int32_t defenderHitpointsBefore; // Hitpoints of the defender before the hit
+    int32_t defenderHitpoints;  // Hitpoints of the defender after the hit
+};
+
+/**
+ * Writes battle log records to a file through a large buffer
+ * Records are copied into the buffer, which goes to the file in one write
+ * when it fills up (and on flush or close), so logging costs a few stores
+ * per record.
+ */
+class BattleLogWriter {
+private:
+    static const size_t BUFFER_RECORDS = 8192; // Records buffered before a write
+
+    FILE* file;
+    std::vector<BattleEvent> buffer;
+    long long recordCount;                     // Records written so far
+    bool failed;                               // Whether a write to the file has failed
+
+public:
+    BattleLogWriter();
+    ~BattleLogWriter();                        // Closes the file
+
+    BattleLogWriter(const BattleLogWriter&) = delete;
+    BattleLogWriter& operator=(const BattleLogWriter&) = delete;
+
+    bool open(const std::string& path);        // Create the file and write its header
+    void write(const BattleEvent& event);
+    void write(const BattleEvent* events, size_t count);
+    void flush();                              // Write out the buffered records
+    bool close();                              // Flush and close the file (false if any write failed)
+    long long getRecordCount() const;
+};
+
+/**
+ * Reads the records of a battle log file in order
+ */
+class BattleLogReader {
+private:
+    static const size_t BUFFER_RECORDS = 8192; // Records read at a time
+
+    FILE* file;
+    std::vector<BattleEvent> buffer;
+    size_t position;                           // Next record in buffer
+
+public:
+    BattleLogReader();
+    ~BattleLogReader();
+
+    BattleLogReader(const BattleLogReader&) = delete;
+    BattleLogReader& operator=(const BattleLogReader&) = delete;
+
+    bool open(const std::string& path);        // Open a file and check its header
+    bool read(BattleEvent& event);             // Next record (false at the end of the file)
+};
+
+// Print a record as the text the interactive simulation prints for it
+void renderBattleEvent(const BattleEvent& event, std::ostream& out);
+
+#endif // BATTLELOG_H
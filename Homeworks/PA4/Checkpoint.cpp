@@ -0,0 +1,116 @@
+#include "Checkpoint.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+static const char CHECKPOINT_MAGIC[8] = { 'R', 'O', 'B', 'O', 'C', 'K', 'P', 'T' };
+static const uint64_t SECTION_ALIGNMENT = 64;
+
+static uint64_t alignUp(uint64_t offset) {
+    return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+// =====================
+// Checkpoint Class Implementation
+// =====================
+
+const uint32_t Checkpoint::CHECKPOINT_VERSION;
+
+Checkpoint::Checkpoint(const string& path) : data(nullptr), size(0) {
+    int file = open(path.c_str(), O_RDONLY);
+    if (file == -1) {
+        return;
+    }
+    struct stat info;
+    if (fstat(file, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(CheckpointHeader)) {
+        void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (mapping != MAP_FAILED) {
+            data = static_cast<const char*>(mapping);
+            size = info.st_size;
+        }
+    }
+    close(file);  // The mapping stays valid without the descriptor
+    if (data == nullptr) {
+        return;
+    }
+
+    // Check the header and that every section lies inside the file
+    const CheckpointHeader& header = getHeader();
+    bool valid = memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) == 0 &&
+                 header.version == CHECKPOINT_VERSION && header.sectionCount == CHECKPOINT_SECTION_COUNT &&
+                 header.fileSize == size;
+    for (int section = 0; valid && section < CHECKPOINT_SECTION_COUNT; section++) {
+        valid = header.sectionOffset[section] % SECTION_ALIGNMENT == 0 &&
+                header.sectionOffset[section] <= size && header.sectionSize[section] <= size - header.sectionOffset[section];
+    }
+    if (!valid) {
+        munmap(const_cast<char*>(data), size);
+        data = nullptr;
+        size = 0;
+    }
+}
+
+Checkpoint::~Checkpoint() {
+    if (data != nullptr) {
+        munmap(const_cast<char*>(data), size);
+    }
+}
+
+bool Checkpoint::isValid() const {
+    return data != nullptr;
+}
+
+const CheckpointHeader& Checkpoint::getHeader() const {
+    return *reinterpret_cast<const CheckpointHeader*>(data);
+}
+
+const void* Checkpoint::getSection(CheckpointSection section) const {
+    return data + getHeader().sectionOffset[section];
+}
+
+SpawnSettings Checkpoint::getSpawnSettings() const {
+    const CheckpointHeader& header = getHeader();
+    SpawnSettings spawning;
+    spawning.respawn = header.respawn != 0;
+    spawning.waveInterval = header.waveInterval;
+    for (int type = 0; type < ROBOT_TYPE_COUNT; type++) {
+        spawning.rate[type] = header.spawnRate[type];
+        spawning.waveSize[type] = header.waveSize[type];
+    }
+    return spawning;
+}
+
+bool Checkpoint::write(const string& path, CheckpointHeader header, const void* const sections[]) {
+    // Lay the sections out one after the other on aligned offsets
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    header.version = CHECKPOINT_VERSION;
+    header.sectionCount = CHECKPOINT_SECTION_COUNT;
+    uint64_t offset = alignUp(sizeof(CheckpointHeader));
+    for (int section = 0; section < CHECKPOINT_SECTION_COUNT; section++) {
+        header.sectionOffset[section] = offset;
+        offset = alignUp(offset + header.sectionSize[section]);
+    }
+    header.fileSize = offset;
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    static const char padding[SECTION_ALIGNMENT] = {};
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+    uint64_t position = sizeof(header);
+    for (int section = 0; written && section < CHECKPOINT_SECTION_COUNT; section++) {
+        uint64_t gap = header.sectionOffset[section] - position;
+        written = fwrite(padding, 1, gap, file) == gap &&
+                  fwrite(sections[section], 1, header.sectionSize[section], file) == header.sectionSize[section];
+        position = header.sectionOffset[section] + header.sectionSize[section];
+    }
+    uint64_t gap = header.fileSize - position;
+    written = written && fwrite(padding, 1, gap, file) == gap;
+    return fclose(file) == 0 && written;
+}
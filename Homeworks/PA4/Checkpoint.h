@@ -0,0 +1,89 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "RobotStore.h"
+#include "SpawnSettings.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Arrays stored in a checkpoint file, in file order
+enum CheckpointSection {
+    SECTION_TYPE,
+    SECTION_HITPOINTS,
+    SECTION_STRENGTH,
+    SECTION_MAX_HITPOINTS,
+    SECTION_HEAL_RATE,
+    SECTION_X,
+    SECTION_Y,
+    SECTION_SEQUENCE,
+    SECTION_BORN_STEP,
+    SECTION_MOVED,          // uint8_t per slot
+    SECTION_ACTIVE,         // uint8_t per slot
+    SECTION_FREE_SLOTS,
+    SECTION_GRID,
+    SECTION_FREE_CELLS,
+    CHECKPOINT_SECTION_COUNT
+};
+
+/**
+ * First bytes of a checkpoint file: the scalar state of a World and where each array is
+ * Every array follows as raw memory (int32_t unless noted above), starting on a
+ * 64-byte boundary, so a mapped file can be used in place. Values are in the byte
+ * order of the machine that wrote them.
+ */
+struct CheckpointHeader {
+    char magic[8];                              // "ROBOCKPT"
+    uint32_t version;                           // CHECKPOINT_VERSION
+    uint32_t sectionCount;                      // CHECKPOINT_SECTION_COUNT
+    uint64_t fileSize;                          // Bytes in the whole file
+    uint64_t sectionOffset[CHECKPOINT_SECTION_COUNT]; // Position of each array in the file
+    uint64_t sectionSize[CHECKPOINT_SECTION_COUNT];   // Bytes in each array
+
+    int32_t width, height;                      // Grid size
+    int32_t stepCount;                          // Steps simulated so far
+    int32_t tileSize;                           // Tile size of parallel steps
+    int32_t slotCount;                          // Robot store slots (used and free)
+    int32_t freeSlotCount;                      // Free robot store slots
+    int32_t freeCellCount;                      // Empty cells
+    int32_t respawn;                            // SpawnSettings::respawn
+    uint64_t seed;                              // Seed the world started from
+    uint64_t randomState[4];                    // Generator state, to continue the same random numbers
+    int32_t waveInterval;                       // SpawnSettings::waveInterval
+    int32_t waveSize[ROBOT_TYPE_COUNT];         // SpawnSettings::waveSize
+    int32_t nextSequence[ROBOT_TYPE_COUNT];     // Name number of the next robot of each type
+    double spawnRate[ROBOT_TYPE_COUNT];         // SpawnSettings::rate
+    double spawnCredit[ROBOT_TYPE_COUNT];       // Fractions of robots owed by the spawn rates
+};
+
+/**
+ * A checkpoint file mapped into memory (read-only)
+ * Opening maps the file and checks its header and section bounds; the arrays
+ * are then read straight from the mapping. One Checkpoint can be shared by
+ * many threads restoring Worlds from it at the same time.
+ */
+class Checkpoint {
+private:
+    const char* data;                           // Start of the mapping (nullptr if the file could not be used)
+    size_t size;                                // Bytes mapped
+
+public:
+    static const uint32_t CHECKPOINT_VERSION = 1;
+
+    explicit Checkpoint(const std::string& path); // Map a checkpoint file (check isValid afterwards)
+    ~Checkpoint();                              // Unmaps the file
+
+    Checkpoint(const Checkpoint&) = delete;
+    Checkpoint& operator=(const Checkpoint&) = delete;
+
+    bool isValid() const;                       // Whether the file was mapped and looks like a checkpoint
+    const CheckpointHeader& getHeader() const;
+    const void* getSection(CheckpointSection section) const; // Start of an array in the mapping
+    SpawnSettings getSpawnSettings() const;     // Spawn settings of the saved world
+
+    // Write a checkpoint: the header (offsets, sizes and magic are filled in here) and each
+    // array given in sections, with the byte count in header.sectionSize. Returns false on failure.
+    static bool write(const std::string& path, CheckpointHeader header, const void* const sections[]);
+};
+
+#endif // CHECKPOINT_H
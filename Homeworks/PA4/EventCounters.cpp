@@ -0,0 +1,54 @@
+#include "EventCounters.h"
+
+using namespace std;
+
+// =====================
+// EventCounters Implementation
+// =====================
+
+EventCounters::EventCounters() {
+    reset();
+}
+
+void EventCounters::reset() {
+    steps = 0;
+    moves = 0;
+    fights = 0;
+    attacks = 0;
+    tacticalNukes = 0;
+    strongAttacks = 0;
+    for (int type = 0; type < ROBOT_TYPE_COUNT; type++) {
+        destroyed[type] = 0;
+        lifetimeSteps[type] = 0;
+        spawned[type] = 0;
+    }
+}
+
+void EventCounters::add(const EventCounters& other) {
+    steps += other.steps;
+    moves += other.moves;
+    fights += other.fights;
+    attacks += other.attacks;
+    tacticalNukes += other.tacticalNukes;
+    strongAttacks += other.strongAttacks;
+    for (int type = 0; type < ROBOT_TYPE_COUNT; type++) {
+        destroyed[type] += other.destroyed[type];
+        lifetimeSteps[type] += other.lifetimeSteps[type];
+        spawned[type] += other.spawned[type];
+    }
+}
+
+void EventCounters::print(ostream& out) const {
+    out << "steps: " << steps << "\n";
+    out << "moves: " << moves << "\n";
+    out << "fights: " << fights << "\n";
+    out << "attacks: " << attacks << "\n";
+    out << "tactical nukes: " << tacticalNukes << "\n";
+    out << "strong attacks: " << strongAttacks << "\n";
+    for (int type = 0; type < ROBOT_TYPE_COUNT; type++) {
+        out << ROBOT_TYPES[type].name << " destroyed: " << destroyed[type] << "\n";
+    }
+    for (int type = 0; type < ROBOT_TYPE_COUNT; type++) {
+        out << ROBOT_TYPES[type].name << " spawned: " << spawned[type] << "\n";
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef EVENTCOUNTERS_H
+#define EVENTCOUNTERS_H
+
+#include "RobotStore.h"
+#include <ostream>
+
+/**
+ * Counts of the events of a simulation, collected by World::simulateFastStep
+ * when a World is given a counters object (headless runs print no messages,
+ * so these are the only record of what happened)
+ */
+struct EventCounters {
+    long long steps;                           // Simulation steps run
+    long long moves;                           // Cells moved into
+    long long fights;                          // Fights started
+    long long attacks;                         // Single attacks (hits) in fights
+    long long tacticalNukes;                   // Humanic tactical nuke attacks
+    long long strongAttacks;                   // OptimusPrime double-damage attacks
+    long long destroyed[ROBOT_TYPE_COUNT];     // Robots destroyed, by type
+    long long lifetimeSteps[ROBOT_TYPE_COUNT]; // Sum of the steps those robots lived, by type
+    long long spawned[ROBOT_TYPE_COUNT];       // Robots added after the start (spawn rates, waves, respawns), by type
+
+    EventCounters();
+    void reset();                              // Set every count to zero
+    void add(const EventCounters& other);      // Add the counts of another simulation
+    void print(std::ostream& out) const;       // Print one "name: count" line per counter
+};
+
+#endif // EVENTCOUNTERS_H
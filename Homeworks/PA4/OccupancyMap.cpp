@@ -0,0 +1,273 @@
+#include "OccupancyMap.h"
+#include <algorithm>
+
+using namespace std;
+
+// =====================
+// OccupancyMap Class Implementation
+// =====================
+
+const int OccupancyMap::ANY;
+const unsigned OccupancyMap::ALL_TYPES;
+
+OccupancyMap::OccupancyMap() : width(0), height(0), columnWords(0), rowWords(0) {
+}
+
+void OccupancyMap::reset(int newWidth, int newHeight) {
+    width = newWidth;
+    height = newHeight;
+    columnWords = (height + 63) / 64;
+    rowWords = (width + 63) / 64;
+    for (int layer = 0; layer <= ANY; layer++) {
+        columns[layer].assign(static_cast<size_t>(width) * columnWords, 0);
+        rows[layer].assign(static_cast<size_t>(height) * rowWords, 0);
+    }
+}
+
+void OccupancyMap::set(int x, int y, int type) {
+    uint64_t columnBit = 1ULL << (y & 63);
+    uint64_t rowBit = 1ULL << (x & 63);
+    size_t columnWord = static_cast<size_t>(x) * columnWords + (y >> 6);
+    size_t rowWord = static_cast<size_t>(y) * rowWords + (x >> 6);
+    columns[type][columnWord] |= columnBit;
+    columns[ANY][columnWord] |= columnBit;
+    rows[type][rowWord] |= rowBit;
+    rows[ANY][rowWord] |= rowBit;
+}
+
+void OccupancyMap::clear(int x, int y, int type) {
+    uint64_t columnBit = 1ULL << (y & 63);
+    uint64_t rowBit = 1ULL << (x & 63);
+    size_t columnWord = static_cast<size_t>(x) * columnWords + (y >> 6);
+    size_t rowWord = static_cast<size_t>(y) * rowWords + (x >> 6);
+    columns[type][columnWord] &= ~columnBit;
+    columns[ANY][columnWord] &= ~columnBit;
+    rows[type][rowWord] &= ~rowBit;
+    rows[ANY][rowWord] &= ~rowBit;
+}
+
+void OccupancyMap::assign(int x, int y, int type) {
+    for (int layer = 0; layer < ROBOT_TYPE_COUNT; layer++) {
+        if (layer != type && isOccupied(x, y, layer)) {
+            clear(x, y, layer);
+        }
+    }
+    if (type != -1) {
+        set(x, y, type);
+    }
+}
+
+bool OccupancyMap::isOccupied(int x, int y, int layer) const {
+    return (column(layer, x)[y >> 6] >> (y & 63)) & 1;
+}
+
+long long OccupancyMap::count(int layer) const {
+    long long total = 0;
+    for (size_t i = 0; i < columns[layer].size(); i++) {
+        total += __builtin_popcountll(columns[layer][i]);
+    }
+    return total;
+}
+
+long long OccupancyMap::countInRect(int layer, int minX, int minY, int maxX, int maxY) const {
+    minX = max(minX, 0);
+    minY = max(minY, 0);
+    maxX = min(maxX, width - 1);
+    maxY = min(maxY, height - 1);
+    long long total = 0;
+    // One bit run per column or per row, whichever makes fewer runs
+    if (maxX - minX <= maxY - minY) {
+        for (int x = minX; x <= maxX; x++) {
+            total += countBits(column(layer, x), minY, maxY);
+        }
+    } else {
+        for (int y = minY; y <= maxY; y++) {
+            total += countBits(row(layer, y), minX, maxX);
+        }
+    }
+    return total;
+}
+
+int OccupancyMap::freeRun(int x, int y, int dx, int dy) const {
+    if (dy > 0) {
+        int next = nextSetBit(column(ANY, x), y + 1, height - 1);
+        return (next == -1 ? height : next) - y - 1;
+    } else if (dy < 0) {
+        int previous = previousSetBit(column(ANY, x), 0, y - 1);
+        return y - previous - 1;
+    } else if (dx > 0) {
+        int next = nextSetBit(row(ANY, y), x + 1, width - 1);
+        return (next == -1 ? width : next) - x - 1;
+    } else {
+        int previous = previousSetBit(row(ANY, y), 0, x - 1);
+        return x - previous - 1;
+    }
+}
+
+// Look at the square rings around (x, y) one after the other; each side of a ring is one bit run
+bool OccupancyMap::findNearest(int x, int y, unsigned typeMask, int maxDistance, int& foundX, int& foundY) const {
+    maxDistance = min(maxDistance, max(width, height));
+    for (int distance = 1; distance <= maxDistance; distance++) {
+        int minX = max(0, x - distance);
+        int maxX = min(width - 1, x + distance);
+        int found;
+        if (y - distance >= 0 && (found = nearestInRow(y - distance, minX, maxX, typeMask)) != -1) {
+            foundX = found;
+            foundY = y - distance;
+            return true;
+        }
+        if (y + distance < height && (found = nearestInRow(y + distance, minX, maxX, typeMask)) != -1) {
+            foundX = found;
+            foundY = y + distance;
+            return true;
+        }
+        int minY = max(0, y - distance + 1);
+        int maxY = min(height - 1, y + distance - 1);
+        if (x - distance >= 0 && (found = nearestInColumn(x - distance, minY, maxY, typeMask)) != -1) {
+            foundX = x - distance;
+            foundY = found;
+            return true;
+        }
+        if (x + distance < width && (found = nearestInColumn(x + distance, minY, maxY, typeMask)) != -1) {
+            foundX = x + distance;
+            foundY = found;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Count the empty cells, pick one by number, then find it column by column
+bool OccupancyMap::randomEmptyCellInRect(Random& random, int minX, int minY, int maxX, int maxY,
+                                         int& foundX, int& foundY) const {
+    minX = max(minX, 0);
+    minY = max(minY, 0);
+    maxX = min(maxX, width - 1);
+    maxY = min(maxY, height - 1);
+    if (minX > maxX || minY > maxY) {
+        return false;
+    }
+    long long columnHeight = maxY - minY + 1;
+    long long emptyCells = (maxX - minX + 1) * columnHeight - countInRect(ANY, minX, minY, maxX, maxY);
+    if (emptyCells == 0) {
+        return false;
+    }
+    long long pick = random.nextInt(static_cast<int>(emptyCells));
+    for (int x = minX; x <= maxX; x++) {
+        long long columnEmpty = columnHeight - countBits(column(ANY, x), minY, maxY);
+        if (pick < columnEmpty) {
+            foundX = x;
+            foundY = nthClearBit(column(ANY, x), minY, maxY, pick);
+            return true;
+        }
+        pick -= columnEmpty;
+    }
+    return false;
+}
+
+long long OccupancyMap::countBits(const uint64_t* bits, int first, int last) {
+    if (first > last) {
+        return 0;
+    }
+    int firstWord = first >> 6;
+    int lastWord = last >> 6;
+    uint64_t firstMask = ~0ULL << (first & 63);
+    uint64_t lastMask = ~0ULL >> (63 - (last & 63));
+    if (firstWord == lastWord) {
+        return __builtin_popcountll(bits[firstWord] & firstMask & lastMask);
+    }
+    long long total = __builtin_popcountll(bits[firstWord] & firstMask) + __builtin_popcountll(bits[lastWord] & lastMask);
+    for (int word = firstWord + 1; word < lastWord; word++) {
+        total += __builtin_popcountll(bits[word]);
+    }
+    return total;
+}
+
+int OccupancyMap::nextSetBit(const uint64_t* bits, int first, int last) {
+    if (first > last) {
+        return -1;
+    }
+    int word = first >> 6;
+    int lastWord = last >> 6;
+    uint64_t value = bits[word] & (~0ULL << (first & 63));
+    while (value == 0) {
+        if (++word > lastWord) {
+            return -1;
+        }
+        value = bits[word];
+    }
+    int position = word * 64 + __builtin_ctzll(value);
+    return position <= last ? position : -1;
+}
+
+int OccupancyMap::previousSetBit(const uint64_t* bits, int first, int last) {
+    if (first > last) {
+        return -1;
+    }
+    int word = last >> 6;
+    int firstWord = first >> 6;
+    uint64_t value = bits[word] & (~0ULL >> (63 - (last & 63)));
+    while (value == 0) {
+        if (--word < firstWord) {
+            return -1;
+        }
+        value = bits[word];
+    }
+    int position = word * 64 + 63 - __builtin_clzll(value);
+    return position >= first ? position : -1;
+}
+
+int OccupancyMap::nthClearBit(const uint64_t* bits, int first, int last, long long n) {
+    for (int word = first >> 6; word <= (last >> 6); word++) {
+        uint64_t mask = ~0ULL;
+        if (word == (first >> 6)) {
+            mask &= ~0ULL << (first & 63);
+        }
+        if (word == (last >> 6)) {
+            mask &= ~0ULL >> (63 - (last & 63));
+        }
+        uint64_t clearBits = ~bits[word] & mask;
+        int clearCount = __builtin_popcountll(clearBits);
+        if (n < clearCount) {
+            // Drop the lowest clear bits until the n-th is the lowest
+            for (; n > 0; n--) {
+                clearBits &= clearBits - 1;
+            }
+            return word * 64 + __builtin_ctzll(clearBits);
+        }
+        n -= clearCount;
+    }
+    return -1;
+}
+
+int OccupancyMap::nearestInRow(int y, int minX, int maxX, unsigned typeMask) const {
+    if ((typeMask & ALL_TYPES) == ALL_TYPES) {
+        return nextSetBit(row(ANY, y), minX, maxX);
+    }
+    int best = -1;
+    for (int type = 0; type < ROBOT_TYPE_COUNT; type++) {
+        if (typeMask & (1u << type)) {
+            int found = nextSetBit(row(type, y), minX, best == -1 ? maxX : best - 1);
+            if (found != -1) {
+                best = found;
+            }
+        }
+    }
+    return best;
+}
+
+int OccupancyMap::nearestInColumn(int x, int minY, int maxY, unsigned typeMask) const {
+    if ((typeMask & ALL_TYPES) == ALL_TYPES) {
+        return nextSetBit(column(ANY, x), minY, maxY);
+    }
+    int best = -1;
+    for (int type = 0; type < ROBOT_TYPE_COUNT; type++) {
+        if (typeMask & (1u << type)) {
+            int found = nextSetBit(column(type, x), minY, best == -1 ? maxY : best - 1);
+            if (found != -1) {
+                best = found;
+            }
+        }
+    }
+    return best;
+}
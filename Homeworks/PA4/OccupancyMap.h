@@ -0,0 +1,65 @@
+#ifndef OCCUPANCYMAP_H
+#define OCCUPANCYMAP_H
+
+#include "RobotStore.h"
+#include "Random.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Packed bitmaps of the occupied cells of a grid, one layer per robot type plus
+ * one for all robots (ANY)
+ * Every layer is kept twice: column by column and row by row, so a run of cells
+ * along either axis is a run of bits in consecutive words. Counting is a popcount
+ * per word, and finding the next robot in a direction skips 64 empty cells per
+ * word, so queries cost about (cells covered / 64) instead of one probe per cell.
+ */
+class OccupancyMap {
+public:
+    static const int ANY = ROBOT_TYPE_COUNT;   // Layer of all robots, whatever their type
+    static const unsigned ALL_TYPES = (1u << ROBOT_TYPE_COUNT) - 1; // Mask of every robot type layer
+
+    OccupancyMap();
+
+    void reset(int newWidth, int newHeight);   // Empty map for a grid of this size
+    void set(int x, int y, int type);          // Mark a cell as holding a robot of a type
+    void clear(int x, int y, int type);        // Mark a cell that held a robot of a type as empty
+    void assign(int x, int y, int type);       // Mark a cell as holding a robot of a type (-1: empty), whatever it held
+
+    bool isOccupied(int x, int y, int layer = ANY) const;
+    uint64_t getColumnWord(int x, int word) const { return column(ANY, x)[word]; } // Bits of cells 64 * word.. of column x
+    long long count(int layer = ANY) const;    // Occupied cells of a layer
+    long long countInRect(int layer, int minX, int minY, int maxX, int maxY) const; // Occupied cells in a rectangle (inclusive)
+
+    // Empty cells between (x, y) and the first occupied cell (or the edge) in the direction (dx, dy),
+    // one of (0, -1), (1, 0), (0, 1), (-1, 0)
+    int freeRun(int x, int y, int dx, int dy) const;
+
+    // Closest cell (in steps along the axes and diagonals) other than (x, y) holding a robot of a type in
+    // typeMask (bit t for RobotType t), at most maxDistance away; false if there is none
+    bool findNearest(int x, int y, unsigned typeMask, int maxDistance, int& foundX, int& foundY) const;
+
+    // Uniformly random empty cell in a rectangle (inclusive); false if the rectangle is full
+    bool randomEmptyCellInRect(Random& random, int minX, int minY, int maxX, int maxY, int& foundX, int& foundY) const;
+
+private:
+    int width, height;
+    int columnWords;                           // Words per column (each column starts a new word)
+    int rowWords;                              // Words per row (each row starts a new word)
+    std::vector<uint64_t> columns[ROBOT_TYPE_COUNT + 1]; // Bit y of column x, for each layer
+    std::vector<uint64_t> rows[ROBOT_TYPE_COUNT + 1];    // Bit x of row y, for each layer
+
+    const uint64_t* column(int layer, int x) const { return &columns[layer][static_cast<size_t>(x) * columnWords]; }
+    const uint64_t* row(int layer, int y) const { return &rows[layer][static_cast<size_t>(y) * rowWords]; }
+
+    // Bit-run helpers over one column or row (bits first to last, inclusive)
+    static long long countBits(const uint64_t* bits, int first, int last);
+    static int nextSetBit(const uint64_t* bits, int first, int last);     // Lowest set bit in the range, or -1
+    static int previousSetBit(const uint64_t* bits, int first, int last); // Highest set bit in the range, or -1
+    static int nthClearBit(const uint64_t* bits, int first, int last, long long n); // Position of the n-th (from 0) clear bit
+    int nearestInRow(int y, int minX, int maxX, unsigned typeMask) const;    // First matching x in a row range, or -1
+    int nearestInColumn(int x, int minY, int maxY, unsigned typeMask) const; // First matching y in a column range, or -1
+};
+
+#endif // OCCUPANCYMAP_H
@@ -0,0 +1,68 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+/**
+ * Small, fast pseudo-random number generator (xoshiro256**)
+ * Each World owns one, so simulations can run on many threads at once and
+ * a simulation started from the same seed makes exactly the same draws.
+ */
+class Random {
+private:
+    uint64_t state[4];  // Generator state (never all zero)
+
+    static uint64_t rotateLeft(uint64_t value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+public:
+    explicit Random(uint64_t seed = 1) {
+        setSeed(seed);
+    }
+
+    // Start the sequence for a seed (any value, including 0, is a valid seed)
+    void setSeed(uint64_t seed) {
+        // Expand the seed into the four state words with splitmix64
+        for (int i = 0; i < 4; i++) {
+            seed += 0x9e3779b97f4a7c15ULL;
+            uint64_t mixed = seed;
+            mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111ebULL;
+            state[i] = mixed ^ (mixed >> 31);
+        }
+    }
+
+    // Copy the generator state out or back in (to continue the same sequence later)
+    void getState(uint64_t out[4]) const {
+        for (int i = 0; i < 4; i++) {
+            out[i] = state[i];
+        }
+    }
+    void setState(const uint64_t in[4]) {
+        for (int i = 0; i < 4; i++) {
+            state[i] = in[i];
+        }
+    }
+
+    // Next 64 random bits
+    uint64_t next() {
+        uint64_t result = rotateLeft(state[1] * 5, 7) * 9;
+        uint64_t shifted = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= shifted;
+        state[3] = rotateLeft(state[3], 45);
+        return result;
+    }
+
+    // Random number from 0 to bound - 1 (bound must be positive), like rand() % bound
+    int nextInt(int bound) {
+        // Scale the top 32 bits instead of taking a remainder: no division, negligible bias
+        return static_cast<int>(((next() >> 32) * static_cast<uint64_t>(bound)) >> 32);
+    }
+};
+
+#endif // RANDOM_H
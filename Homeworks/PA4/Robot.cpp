@@ -1,8 +1,7 @@
 #include "Robot.h"
 #include "World.h"
 #include <iostream>
-#include <cstdlib> // for rand()
-#include <ctime>   // for time()
+#include <algorithm> // for min()
 
 using namespace std;
 
@@ -10,13 +9,8 @@ using namespace std;
 // Robot Base Class Implementation
 // =====================
 
-Robot::Robot() : strength(0), hitpoints(0), name(""), x(0), y(0), moved(false), world(nullptr) {
-}
-
-Robot::Robot(int newStrength, int newHitpoints, const string& newName, World* newWorld, int newX, int newY) 
-    : strength(newStrength), hitpoints(newHitpoints), name(newName), 
-      x(newX), y(newY), moved(false), world(newWorld) {
-    // World grid setting is handled by World class
+Robot::Robot(World* newWorld, int newSlot) : world(newWorld), slot(newSlot) {
+    // The robot's data is stored by the World class before the facade is created
 }
 
 Robot::~Robot() {
@@ -25,13 +19,13 @@ Robot::~Robot() {
 
 int Robot::getDamage() {
     // Base damage calculation for all robots (random number between 1 and strength)
-    int damage = (rand() % strength) + 1;
+    int damage = world->getRandom().nextInt(getStrength()) + 1;
     cout << getType() << " attacks for " << damage << " points!" << endl;
     return damage;
 }
 
 bool Robot::isAlive() const {
-    return hitpoints > 0;
+    return getHitpoints() > 0;
 }
 
 void Robot::heal() {
@@ -41,71 +35,66 @@ void Robot::heal() {
 
 // Accessor methods
 int Robot::getStrength() const {
-    return strength;
+    return world->getStore().strength[slot];
 }
 
 int Robot::getHitpoints() const {
-    return hitpoints;
+    return world->getStore().hitpoints[slot];
 }
 
 string Robot::getName() const {
-    return name;
+    return getType() + "_" + to_string(world->getStore().sequence[slot]);
 }
 
 int Robot::getX() const {
-    return x;
+    return world->getStore().x[slot];
 }
 
 int Robot::getY() const {
-    return y;
+    return world->getStore().y[slot];
 }
 
 bool Robot::hasMoved() const {
-    return moved;
+    return world->getStore().moved[slot] != 0;
+}
+
+int Robot::getSlot() const {
+    return slot;
 }
 
 // Mutator methods
 void Robot::setStrength(int newStrength) {
-    strength = newStrength;
+    world->getStore().strength[slot] = newStrength;
 }
 
 void Robot::setHitpoints(int newHitpoints) {
-    hitpoints = newHitpoints;
-}
-
-void Robot::setName(const string& newName) {
-    name = newName;
+    world->getStore().hitpoints[slot] = newHitpoints;
 }
 
 void Robot::setPosition(int newX, int newY) {
-    x = newX;
-    y = newY;
+    world->getStore().x[slot] = newX;
+    world->getStore().y[slot] = newY;
 }
 
 void Robot::setMoved(bool hasMoved) {
-    moved = hasMoved;
+    world->getStore().moved[slot] = hasMoved ? 1 : 0;
 }
 
 void Robot::takeDamage(int damage) {
-    hitpoints -= damage;
+    world->getStore().hitpoints[slot] -= damage;
 }
 
 void Robot::displayInfo() const {
-    cout << "Robot: " << name << " (" << getType() << ")" << endl;
-    cout << "HP: " << hitpoints << ", Strength: " << strength << endl;
-    cout << "Position: (" << x << ", " << y << ")" << endl;
+    cout << "Robot: " << getName() << " (" << getType() << ")" << endl;
+    cout << "HP: " << getHitpoints() << ", Strength: " << getStrength() << endl;
+    cout << "Position: (" << getX() << ", " << getY() << ")" << endl;
 }
 
 // =====================
 // Humanic Class Implementation
 // =====================
 
-Humanic::Humanic() : Robot() {
-}
-
-Humanic::Humanic(int newStrength, int newHitpoints, const string& newName, 
-                World* newWorld, int newX, int newY)
-    : Robot(newStrength, newHitpoints, newName, newWorld, newX, newY) {
+Humanic::Humanic(World* newWorld, int newSlot) : Robot(newWorld, newSlot) {
 }
 
 Humanic::~Humanic() {
@@ -117,7 +106,7 @@ int Humanic::getDamage() {
     int damage = Robot::getDamage();
     
     // 15% chance of inflicting tactical nuke (40 additional damage)
-    if ((rand() % 100) < 15) {
+    if (world->getRandom().nextInt(100) < 15) {
         cout << "Humanic robot " << getName() << " inflicts a TACTICAL NUKE attack!" << endl;
         damage += 40;
     }
@@ -127,24 +116,16 @@ int Humanic::getDamage() {
 
 void Humanic::heal() {
     // Humanic robots heal 1 hit point per step
-    hitpoints++;
-    // Can't heal beyond initial values, assuming:
-    // OptimusPrime max = 100, Robocop max = 40
-    int maxHitpoints = (getType() == "optimusprime") ? 100 : 40;
-    if (hitpoints > maxHitpoints) {
-        hitpoints = maxHitpoints;
-    }
+    // Can't heal beyond initial values (OptimusPrime max = 100, Robocop max = 40)
+    RobotStore& store = world->getStore();
+    store.hitpoints[slot] = min(store.hitpoints[slot] + store.healRate[slot], store.maxHitpoints[slot]);
 }
 
 // =====================
 // OptimusPrime Class Implementation
 // =====================
 
-OptimusPrime::OptimusPrime() : Humanic() {
-}
-
-OptimusPrime::OptimusPrime(World* newWorld, int newX, int newY, int sequence)
-    : Humanic(100, 100, "optimusprime_" + to_string(sequence), newWorld, newX, newY) {
+OptimusPrime::OptimusPrime(World* newWorld, int newSlot) : Humanic(newWorld, newSlot) {
 }
 
 OptimusPrime::~OptimusPrime() {
@@ -160,7 +141,7 @@ int OptimusPrime::getDamage() {
     int damage = Humanic::getDamage();
     
     // 20% chance of doubling damage
-    if ((rand() % 100) < 20) {
+    if (world->getRandom().nextInt(100) < 20) {
         cout << "OptimusPrime " << getName() << " inflicts a STRONG attack, doubling damage!" << endl;
         damage *= 2;
     }
@@ -170,10 +151,10 @@ int OptimusPrime::getDamage() {
 
 void OptimusPrime::move() {
     // Choose a random direction
-    int direction = rand() % 4; // 0: up, 1: right, 2: down, 3: left
+    int direction = world->getRandom().nextInt(4); // 0: up, 1: right, 2: down, 3: left
     bool keepMoving = true;
-    int currentX = x;
-    int currentY = y;
+    int currentX = getX();
+    int currentY = getY();
     
     while (keepMoving) {
         int newX = currentX;
@@ -197,8 +178,8 @@ void OptimusPrime::move() {
                 keepMoving = false;
             } else {
                 // Position updated, get new position
-                currentX = x;
-                currentY = y;
+                currentX = getX();
+                currentY = getY();
             }
         } else {
             keepMoving = false;
@@ -210,11 +191,7 @@ void OptimusPrime::move() {
 // Robocop Class Implementation
 // =====================
 
-Robocop::Robocop() : Humanic() {
-}
-
-Robocop::Robocop(World* newWorld, int newX, int newY, int sequence)
-    : Humanic(30, 40, "robocop_" + to_string(sequence), newWorld, newX, newY) {
+Robocop::Robocop(World* newWorld, int newSlot) : Humanic(newWorld, newSlot) {
 }
 
 Robocop::~Robocop() {
@@ -227,10 +204,10 @@ string Robocop::getType() const {
 
 void Robocop::move() {
     // Choose a random direction
-    int direction = rand() % 4; // 0: up, 1: right, 2: down, 3: left
+    int direction = world->getRandom().nextInt(4); // 0: up, 1: right, 2: down, 3: left
     bool keepMoving = true;
-    int currentX = x;
-    int currentY = y;
+    int currentX = getX();
+    int currentY = getY();
     
     while (keepMoving) {
         int newX = currentX;
@@ -254,8 +231,8 @@ void Robocop::move() {
                 keepMoving = false;
             } else {
                 // Position updated, get new position
-                currentX = x;
-                currentY = y;
+                currentX = getX();
+                currentY = getY();
             }
         } else {
             keepMoving = false;
@@ -267,11 +244,7 @@ void Robocop::move() {
 // Roomba Class Implementation
 // =====================
 
-Roomba::Roomba() : Robot() {
-}
-
-Roomba::Roomba(World* newWorld, int newX, int newY, int sequence)
-    : Robot(3, 10, "roomba_" + to_string(sequence), newWorld, newX, newY) {
+Roomba::Roomba(World* newWorld, int newSlot) : Robot(newWorld, newSlot) {
 }
 
 Roomba::~Roomba() {
@@ -286,7 +259,7 @@ int Roomba::getDamage() {
     // Roomba attacks twice
     int damage1 = Robot::getDamage();
     cout << getName() << " attacks again as it's very fast!" << endl;
-    int damage2 = (rand() % strength) + 1; // Second attack calculation
+    int damage2 = world->getRandom().nextInt(getStrength()) + 1; // Second attack calculation
     cout << getType() << " attacks for " << damage2 << " more points!" << endl;
     
     return damage1 + damage2;
@@ -294,10 +267,10 @@ int Roomba::getDamage() {
 
 void Roomba::move() {
     // Choose a random direction
-    int direction = rand() % 4; // 0: up, 1: right, 2: down, 3: left
+    int direction = world->getRandom().nextInt(4); // 0: up, 1: right, 2: down, 3: left
     bool keepMoving = true;
-    int currentX = x;
-    int currentY = y;
+    int currentX = getX();
+    int currentY = getY();
     
     while (keepMoving) {
         int newX = currentX;
@@ -321,8 +294,8 @@ void Roomba::move() {
                 keepMoving = false;
             } else {
                 // Position updated, get new position
-                currentX = x;
-                currentY = y;
+                currentX = getX();
+                currentY = getY();
             }
         } else {
             keepMoving = false;
@@ -334,11 +307,7 @@ void Roomba::move() {
 // Bulldozer Class Implementation
 // =====================
 
-Bulldozer::Bulldozer() : Robot() {
-}
-
-Bulldozer::Bulldozer(World* newWorld, int newX, int newY, int sequence)
-    : Robot(50, 200, "bulldozer_" + to_string(sequence), newWorld, newX, newY) {
+Bulldozer::Bulldozer(World* newWorld, int newSlot) : Robot(newWorld, newSlot) {
 }
 
 Bulldozer::~Bulldozer() {
@@ -351,10 +320,10 @@ string Bulldozer::getType() const {
 
 void Bulldozer::move() {
     // Choose a random direction
-    int direction = rand() % 4; // 0: up, 1: right, 2: down, 3: left
+    int direction = world->getRandom().nextInt(4); // 0: up, 1: right, 2: down, 3: left
     bool keepMoving = true;
-    int currentX = x;
-    int currentY = y;
+    int currentX = getX();
+    int currentY = getY();
     
     while (keepMoving) {
         int newX = currentX;
@@ -378,8 +347,8 @@ void Bulldozer::move() {
                 keepMoving = false;
             } else {
                 // Position updated, get new position
-                currentX = x;
-                currentY = y;
+                currentX = getX();
+                currentY = getY();
             }
         } else {
             keepMoving = false;
@@ -391,11 +360,7 @@ void Bulldozer::move() {
 // Kamikaze Class Implementation
 // =====================
 
-Kamikaze::Kamikaze() : Robot() {
-}
-
-Kamikaze::Kamikaze(World* newWorld, int newX, int newY, int sequence)
-    : Robot(10, 10, "kamikaze_" + to_string(sequence), newWorld, newX, newY) {
+Kamikaze::Kamikaze(World* newWorld, int newSlot) : Robot(newWorld, newSlot) {
 }
 
 Kamikaze::~Kamikaze() {
@@ -408,21 +373,21 @@ string Kamikaze::getType() const {
 
 int Kamikaze::getDamage() {
     // Kamikaze inflicts damage equal to its hitpoints
-    int damage = hitpoints;
+    int damage = getHitpoints();
     cout << getName() << " performs a KAMIKAZE attack for " << damage << " points!" << endl;
     
     // Kamikaze dies after attack
-    hitpoints = 0;
+    setHitpoints(0);
     
     return damage;
 }
 
 void Kamikaze::move() {
     // Choose a random direction
-    int direction = rand() % 4; // 0: up, 1: right, 2: down, 3: left
+    int direction = world->getRandom().nextInt(4); // 0: up, 1: right, 2: down, 3: left
     bool keepMoving = true;
-    int currentX = x;
-    int currentY = y;
+    int currentX = getX();
+    int currentY = getY();
     
     while (keepMoving) {
         int newX = currentX;
@@ -446,8 +411,8 @@ void Kamikaze::move() {
                 keepMoving = false;
             } else {
                 // Position updated, get new position
-                currentX = x;
-                currentY = y;
+                currentX = getX();
+                currentY = getY();
             }
         } else {
             keepMoving = false;
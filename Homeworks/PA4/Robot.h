@@ -3,7 +3,6 @@
 
 #include <string>
 #include <iostream>
-#include <cstdlib> // for rand()
 
 // Forward declaration
 class World;
@@ -11,20 +10,17 @@ class World;
 /**
  * Base Robot class for the robot battle simulation
  * This class will be the parent for all robot types
+ * A robot is a thin facade: its data lives in the world's RobotStore at its slot,
+ * so the data-oriented step and the classes below always see the same state
  */
 class Robot {
 protected:
-    int strength;      // Attack strength
-    int hitpoints;     // Health points
-    std::string name;  // Robot name (format: type_sequence)
-    int x, y;          // Position in the world grid
-    bool moved;        // Flag to track if robot has moved in current simulation step
     World* world;      // Reference to the world the robot exists in
+    int slot;          // Index of the robot's data in the world's robot store
 
 public:
     // Constructors and destructor
-    Robot();
-    Robot(int newStrength, int newHitpoints, const std::string& newName, World* newWorld, int newX, int newY);
+    Robot(World* newWorld, int newSlot);
     virtual ~Robot();
 
     // Core virtual functions (to be overridden by derived classes)
@@ -43,11 +39,11 @@ public:
     int getX() const;
     int getY() const;
     bool hasMoved() const;
+    int getSlot() const;
     
     // Mutator methods
     void setStrength(int newStrength);
     void setHitpoints(int newHitpoints);
-    void setName(const std::string& newName);
     void setPosition(int newX, int newY);
     void setMoved(bool hasMoved);
     
@@ -62,8 +58,7 @@ public:
  */
 class Humanic : public Robot {
 public:
-    Humanic();
-    Humanic(int newStrength, int newHitpoints, const std::string& newName, World* newWorld, int newX, int newY);
+    Humanic(World* newWorld, int newSlot);
     virtual ~Humanic();
     
     virtual int getDamage() override;  // Add 15% chance for tactical nuke
@@ -76,8 +71,7 @@ public:
  */
 class OptimusPrime : public Humanic {
 public:
-    OptimusPrime();
-    OptimusPrime(World* newWorld, int newX, int newY, int sequence);
+    OptimusPrime(World* newWorld, int newSlot);
     virtual ~OptimusPrime();
     
     virtual std::string getType() const override;
@@ -91,8 +85,7 @@ public:
  */
 class Robocop : public Humanic {
 public:
-    Robocop();
-    Robocop(World* newWorld, int newX, int newY, int sequence);
+    Robocop(World* newWorld, int newSlot);
     virtual ~Robocop();
     
     virtual std::string getType() const override;
@@ -105,8 +98,7 @@ public:
  */
 class Roomba : public Robot {
 public:
-    Roomba();
-    Roomba(World* newWorld, int newX, int newY, int sequence);
+    Roomba(World* newWorld, int newSlot);
     virtual ~Roomba();
     
     virtual std::string getType() const override;
@@ -120,8 +112,7 @@ public:
  */
 class Bulldozer : public Robot {
 public:
-    Bulldozer();
-    Bulldozer(World* newWorld, int newX, int newY, int sequence);
+    Bulldozer(World* newWorld, int newSlot);
     virtual ~Bulldozer();
     
     virtual std::string getType() const override;
@@ -134,8 +125,7 @@ public:
  */
 class Kamikaze : public Robot {
 public:
-    Kamikaze();
-    Kamikaze(World* newWorld, int newX, int newY, int sequence);
+    Kamikaze(World* newWorld, int newSlot);
     virtual ~Kamikaze();
     
     virtual std::string getType() const override;
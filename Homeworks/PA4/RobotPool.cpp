@@ -0,0 +1,69 @@
+#include "RobotPool.h"
+#include "Robot.h"
+#include <cstddef>
+#include <new>
+
+using namespace std;
+
+// Size of one place: large enough (and aligned) for every robot class
+template <typename T>
+static constexpr size_t maxSize(size_t size) {
+    return sizeof(T) > size ? sizeof(T) : size;
+}
+static const size_t PLACE_SIZE =
+    (maxSize<OptimusPrime>(maxSize<Robocop>(maxSize<Roomba>(maxSize<Bulldozer>(sizeof(Kamikaze))))) + alignof(max_align_t) - 1)
+    / alignof(max_align_t) * alignof(max_align_t);
+
+// =====================
+// RobotPool Class Implementation
+// =====================
+
+RobotPool::RobotPool() {
+}
+
+RobotPool::~RobotPool() {
+    for (size_t slot = 0; slot < robots.size(); slot++) {
+        if (robots[slot] != nullptr) {
+            robots[slot]->~Robot();
+        }
+    }
+    for (size_t i = 0; i < chunks.size(); i++) {
+        delete[] chunks[i];
+    }
+}
+
+void* RobotPool::place(int slot) {
+    // Chunks are added in order, so a slot's chunk exists once every earlier chunk does
+    while (slot >= static_cast<int>(chunks.size()) * CHUNK_SIZE) {
+        chunks.push_back(new char[PLACE_SIZE * CHUNK_SIZE]);
+        robots.resize(chunks.size() * CHUNK_SIZE, nullptr);
+    }
+    return chunks[slot / CHUNK_SIZE] + PLACE_SIZE * (slot % CHUNK_SIZE);
+}
+
+Robot* RobotPool::create(RobotType type, World* world, int slot) {
+    destroy(slot);  // A place holds one robot at a time
+    void* memory = place(slot);
+
+    Robot* robot;
+    switch (type) {
+        case OPTIMUS_PRIME: robot = new (memory) OptimusPrime(world, slot); break;
+        case ROBOCOP:       robot = new (memory) Robocop(world, slot); break;
+        case ROOMBA:        robot = new (memory) Roomba(world, slot); break;
+        case BULLDOZER:     robot = new (memory) Bulldozer(world, slot); break;
+        default:            robot = new (memory) Kamikaze(world, slot); break;
+    }
+    robots[slot] = robot;
+    return robot;
+}
+
+void RobotPool::destroy(int slot) {
+    if (slot < static_cast<int>(robots.size()) && robots[slot] != nullptr) {
+        robots[slot]->~Robot();
+        robots[slot] = nullptr;
+    }
+}
+
+Robot* RobotPool::get(int slot) const {
+    return robots[slot];
+}
@@ -0,0 +1,39 @@
+#ifndef ROBOTPOOL_H
+#define ROBOTPOOL_H
+
+#include "RobotStore.h"
+#include <vector>
+
+// Forward declarations
+class Robot;
+class World;
+
+/**
+ * Pool of Robot objects owned by a World, one place per robot store slot
+ * Robots are built in place in large chunks of memory instead of with new, so
+ * creating and destroying a robot is O(1) and never calls malloc once the pool
+ * has grown to the largest population. Places are reused with their slots, and
+ * every chunk is released at once when the pool is destroyed. A robot never
+ * moves in memory, so Robot pointers stay valid until the robot is destroyed.
+ */
+class RobotPool {
+private:
+    static const int CHUNK_SIZE = 1024;      // Robots per chunk
+
+    std::vector<char*> chunks;               // Memory for CHUNK_SIZE robots each
+    std::vector<Robot*> robots;              // Robot in each place (nullptr for an empty place)
+
+    void* place(int slot);                   // Memory of a slot's place, growing the pool if needed
+
+public:
+    RobotPool();
+    ~RobotPool();                            // Destroys the remaining robots and releases every chunk
+    RobotPool(const RobotPool&) = delete;
+    RobotPool& operator=(const RobotPool&) = delete;
+
+    Robot* create(RobotType type, World* world, int slot);  // Build a robot of the given type in a slot's place
+    void destroy(int slot);                  // Destroy the robot in a slot's place
+    Robot* get(int slot) const;              // Robot in a slot's place (nullptr if empty)
+};
+
+#endif // ROBOTPOOL_H
@@ -0,0 +1,152 @@
+#include "RobotStore.h"
+#include <algorithm>
+
+using namespace std;
+
+const RobotTypeInfo ROBOT_TYPES[ROBOT_TYPE_COUNT] = {
+    { "optimusprime", 100, 100, 1 },
+    { "robocop",       30,  40, 1 },
+    { "roomba",         3,  10, 0 },
+    { "bulldozer",     50, 200, 0 },
+    { "kamikaze",      10,  10, 0 }
+};
+
+// =====================
+// RobotStore Class Implementation
+// =====================
+
+RobotStore::RobotStore() {
+    clear();
+}
+
+int RobotStore::add(RobotType newType, int newX, int newY, int newSequence, int newBornStep) {
+    const RobotTypeInfo& info = ROBOT_TYPES[newType];
+    int slot;
+
+    // Reuse a free slot if there is one, otherwise grow every array by one
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = static_cast<int>(type.size());
+        type.push_back(0);
+        hitpoints.push_back(0);
+        strength.push_back(0);
+        maxHitpoints.push_back(0);
+        healRate.push_back(0);
+        x.push_back(0);
+        y.push_back(0);
+        sequence.push_back(0);
+        bornStep.push_back(0);
+        moved.push_back(0);
+        active.push_back(0);
+    }
+
+    type[slot] = newType;
+    hitpoints[slot] = info.hitpoints;
+    strength[slot] = info.strength;
+    maxHitpoints[slot] = info.hitpoints;
+    healRate[slot] = info.healRate;
+    x[slot] = newX;
+    y[slot] = newY;
+    sequence[slot] = newSequence;
+    bornStep[slot] = newBornStep;
+    moved[slot] = 0;
+    active[slot] = 1;
+    activeCount++;
+    typeCounts[newType]++;
+    return slot;
+}
+
+void RobotStore::remove(int slot) {
+    if (!active[slot]) {
+        return;
+    }
+
+    // A free slot must not be touched by the per-step passes
+    active[slot] = 0;
+    hitpoints[slot] = 0;
+    healRate[slot] = 0;
+    freeSlots.push_back(slot);
+    activeCount--;
+    typeCounts[type[slot]]--;
+}
+
+void RobotStore::clear() {
+    type.clear();
+    hitpoints.clear();
+    strength.clear();
+    maxHitpoints.clear();
+    healRate.clear();
+    x.clear();
+    y.clear();
+    sequence.clear();
+    bornStep.clear();
+    moved.clear();
+    active.clear();
+    freeSlots.clear();
+    activeCount = 0;
+    for (int countType = 0; countType < ROBOT_TYPE_COUNT; countType++) {
+        typeCounts[countType] = 0;
+    }
+}
+
+void RobotStore::restore(int slotCount, const int* newFreeSlots, int freeSlotCount) {
+    type.resize(slotCount);
+    hitpoints.resize(slotCount);
+    strength.resize(slotCount);
+    maxHitpoints.resize(slotCount);
+    healRate.resize(slotCount);
+    x.resize(slotCount);
+    y.resize(slotCount);
+    sequence.resize(slotCount);
+    bornStep.resize(slotCount);
+    moved.resize(slotCount);
+    active.resize(slotCount);
+    freeSlots.assign(newFreeSlots, newFreeSlots + freeSlotCount);
+}
+
+void RobotStore::recount() {
+    activeCount = 0;
+    for (int countType = 0; countType < ROBOT_TYPE_COUNT; countType++) {
+        typeCounts[countType] = 0;
+    }
+    for (int slot = 0; slot < getSlotCount(); slot++) {
+        if (active[slot]) {
+            activeCount++;
+            typeCounts[type[slot]]++;
+        }
+    }
+}
+
+const vector<int>& RobotStore::getFreeSlots() const {
+    return freeSlots;
+}
+
+int RobotStore::getSlotCount() const {
+    return static_cast<int>(type.size());
+}
+
+int RobotStore::getActiveCount() const {
+    return activeCount;
+}
+
+int RobotStore::getTypeCount(RobotType countType) const {
+    return typeCounts[countType];
+}
+
+void RobotStore::resetMoved() {
+    fill(moved.begin(), moved.end(), 0);
+}
+
+void RobotStore::healAll() {
+    // Branch-free so the loop vectorizes: dead robots and free slots get a heal of 0
+    int* hp = hitpoints.data();
+    const int* rate = healRate.data();
+    const int* cap = maxHitpoints.data();
+    int count = getSlotCount();
+    for (int i = 0; i < count; i++) {
+        int healed = hp[i] + (hp[i] > 0 ? rate[i] : 0);
+        hp[i] = healed < cap[i] ? healed : cap[i];
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef ROBOTSTORE_H
+#define ROBOTSTORE_H
+
+#include <cstdint>
+#include <vector>
+
+// Type tag of a robot in the robot store
+enum RobotType {
+    OPTIMUS_PRIME,
+    ROBOCOP,
+    ROOMBA,
+    BULLDOZER,
+    KAMIKAZE,
+    ROBOT_TYPE_COUNT
+};
+
+/**
+ * Fixed properties of one robot type
+ */
+struct RobotTypeInfo {
+    const char* name;   // Type name as printed (also the prefix of robot names)
+    int strength;       // Initial attack strength
+    int hitpoints;      // Initial (and maximum) hitpoints
+    int healRate;       // Hitpoints regained per step (only humanic robots heal)
+};
+
+// Properties of every robot type, indexed by RobotType
+extern const RobotTypeInfo ROBOT_TYPES[ROBOT_TYPE_COUNT];
+
+/**
+ * Structure-of-arrays storage for all robots of a world
+ * Each robot is a slot index; every property lives in its own contiguous array,
+ * so per-step passes (healing, clearing moved flags) run as tight loops the
+ * compiler can vectorize. Slots of removed robots are reused by later robots,
+ * so the slot of a live robot never changes.
+ */
+class RobotStore {
+public:
+    std::vector<int> type;        // RobotType of each slot
+    std::vector<int> hitpoints;   // Current hitpoints
+    std::vector<int> strength;    // Attack strength
+    std::vector<int> maxHitpoints; // Hitpoints cap for healing
+    std::vector<int> healRate;    // Hitpoints regained per step (0 for free slots)
+    std::vector<int> x, y;        // Position in the world grid
+    std::vector<int> sequence;    // Number in the robot's name (e.g., 3 for roomba_3)
+    std::vector<int> bornStep;    // Step in which the robot was created (0 for the initial robots)
+    std::vector<uint8_t> moved;   // Whether the robot has moved in the current step
+    std::vector<uint8_t> active;  // Whether the slot holds a robot
+
+    RobotStore();
+
+    int add(RobotType newType, int newX, int newY, int newSequence, int newBornStep = 0);  // Stores a new robot, returns its slot
+    void remove(int slot);                   // Frees the slot of a robot
+    void clear();                            // Removes all robots
+    void restore(int slotCount, const int* newFreeSlots, int freeSlotCount); // Resizes to slotCount slots with the given free slots
+                                             // (the caller fills in the arrays, then calls recount)
+    void recount();                          // Recomputes the robot counts from the active and type arrays
+    const std::vector<int>& getFreeSlots() const; // Free slots, in the order they will be reused (last first)
+
+    int getSlotCount() const;                // Number of slots (used and free)
+    int getActiveCount() const;              // Number of slots holding a robot
+    int getTypeCount(RobotType countType) const; // Number of slots holding a robot of a type
+
+    // Per-step passes over all slots
+    void resetMoved();                       // Clears every moved flag
+    void healAll();                          // Heals every living robot by its heal rate, up to its maximum
+
+private:
+    std::vector<int> freeSlots;              // Slots of removed robots, reused first
+    int activeCount;                         // Number of slots holding a robot
+    int typeCounts[ROBOT_TYPE_COUNT];        // Number of slots holding a robot, by type
+};
+
+#endif // ROBOTSTORE_H
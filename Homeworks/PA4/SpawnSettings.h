@@ -0,0 +1,24 @@
+#ifndef SPAWNSETTINGS_H
+#define SPAWNSETTINGS_H
+
+#include "RobotStore.h"
+
+/**
+ * How a World keeps adding robots during a simulation
+ * By default nothing is added, and a simulation ends when one robot is left.
+ * With spawn rates or waves the population keeps being refilled, so the
+ * simulation runs until a step limit (for load tests and long scenarios).
+ * New robots are placed on random empty cells; when the grid is full they
+ * are not created.
+ */
+struct SpawnSettings {
+    double rate[ROBOT_TYPE_COUNT];     // Robots of each type added per step (fractions add up over the steps)
+    int waveInterval;                  // Steps between spawn waves (0: no waves)
+    int waveSize[ROBOT_TYPE_COUNT];    // Robots of each type added by each wave
+    bool respawn;                      // Whether a destroyed robot is replaced at the end of the step
+
+    SpawnSettings();
+    bool isContinuous() const;         // Whether robots keep being added however many are left
+};
+
+#endif // SPAWNSETTINGS_H
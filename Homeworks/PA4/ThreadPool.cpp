@@ -0,0 +1,89 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+using namespace std;
+
+// =====================
+// ThreadPool Class Implementation
+// =====================
+
+ThreadPool::ThreadPool(int threads)
+    : task(nullptr), taskCount(0), nextTask(0), batch(0), busyWorkers(0), stopping(false) {
+    if (threads <= 0) {
+        threads = max(1, static_cast<int>(thread::hardware_concurrency()));
+    }
+    // The caller of run() is one of the threads
+    for (int i = 1; i < threads; i++) {
+        workers.push_back(thread(&ThreadPool::workerLoop, this));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(poolMutex);
+        stopping = true;
+    }
+    workReady.notify_all();
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+}
+
+void ThreadPool::run(int count, const function<void(int)>& newTask) {
+    if (count <= 0) {
+        return;
+    }
+    if (workers.empty() || count == 1) {
+        for (int i = 0; i < count; i++) {
+            newTask(i);
+        }
+        return;
+    }
+
+    {
+        lock_guard<mutex> lock(poolMutex);
+        task = &newTask;
+        taskCount = count;
+        nextTask = 0;
+        busyWorkers = static_cast<int>(workers.size());
+        batch++;
+    }
+    workReady.notify_all();
+    runTasks();
+
+    // Wait for the workers to finish their last tasks
+    unique_lock<mutex> lock(poolMutex);
+    workDone.wait(lock, [this] { return busyWorkers == 0; });
+    task = nullptr;
+}
+
+int ThreadPool::getThreadCount() const {
+    return static_cast<int>(workers.size()) + 1;
+}
+
+void ThreadPool::workerLoop() {
+    int seenBatch = 0;
+    while (true) {
+        {
+            unique_lock<mutex> lock(poolMutex);
+            workReady.wait(lock, [this, seenBatch] { return stopping || batch != seenBatch; });
+            if (stopping) {
+                return;
+            }
+            seenBatch = batch;
+        }
+
+        runTasks();
+
+        lock_guard<mutex> lock(poolMutex);
+        if (--busyWorkers == 0) {
+            workDone.notify_one();
+        }
+    }
+}
+
+void ThreadPool::runTasks() {
+    for (int i = nextTask++; i < taskCount; i = nextTask++) {
+        (*task)(i);
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed set of worker threads that run numbered tasks in parallel
+ * run() hands out the task numbers to the workers (and the calling thread)
+ * and returns when every task has finished, so the tasks of one call never
+ * overlap with the next. The threads are started once and reused by every
+ * call, so a simulation step does not pay for creating threads.
+ */
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::mutex poolMutex;                     // Guards the batch state below (except nextTask)
+    std::condition_variable workReady;        // Signalled when a new batch of tasks starts (or on shutdown)
+    std::condition_variable workDone;         // Signalled when the last worker leaves a batch
+    const std::function<void(int)>* task;     // Task of the current batch
+    int taskCount;                            // Number of tasks in the current batch
+    std::atomic<int> nextTask;                // Next task number to hand out
+    int batch;                                // Number of the current batch (workers wait for a new one)
+    int busyWorkers;                          // Workers still working on the current batch
+    bool stopping;                            // Whether the workers should exit
+
+    void workerLoop();                        // Wait for batches and run their tasks
+    void runTasks();                          // Run tasks of the current batch until none are left
+
+public:
+    explicit ThreadPool(int threads = 0);     // Threads including the caller of run() (0: one per core)
+    ~ThreadPool();                            // Stops and joins the workers
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void run(int count, const std::function<void(int)>& newTask); // Run newTask(0) to newTask(count - 1) and wait
+    int getThreadCount() const;               // Threads that run tasks, including the caller
+};
+
+#endif // THREADPOOL_H
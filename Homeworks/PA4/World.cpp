@@ -1,82 +1,108 @@
 #include "World.h"
 #include "Robot.h"
+#include "Checkpoint.h"
 #include <iostream>
-#include <cstdlib> // for rand()
 #include <ctime>   // for time()
 #include <utility> // for pair
+#include <algorithm> // for max()
+#include <cstring>   // for memcpy()
 
 using namespace std;
 
 // =====================
-// World Class Implementation
+// SpawnSettings Implementation
 // =====================
 
-World::World() : robotCount(0), stepCount(0) {
-    // Initialize the grid to nullptr
-    for (int i = 0; i < GRID_SIZE; i++) {
-        for (int j = 0; j < GRID_SIZE; j++) {
-            grid[i][j] = nullptr;
-        }
+SpawnSettings::SpawnSettings() : waveInterval(0), respawn(false) {
+    for (int type = 0; type < ROBOT_TYPE_COUNT; type++) {
+        rate[type] = 0;
+        waveSize[type] = 0;
     }
 }
 
-World::~World() {
-    // Clean up all robots in the grid
-    for (int i = 0; i < GRID_SIZE; i++) {
-        for (int j = 0; j < GRID_SIZE; j++) {
-            if (grid[i][j] != nullptr) {
-                delete grid[i][j];
-                grid[i][j] = nullptr;
-            }
+bool SpawnSettings::isContinuous() const {
+    for (int type = 0; type < ROBOT_TYPE_COUNT; type++) {
+        if (rate[type] > 0 || (waveInterval > 0 && waveSize[type] > 0)) {
+            return true;
         }
     }
+    return false;
+}
+
+// =====================
+// World Class Implementation
+// =====================
+
+// Definitions of the constants (needed when they are passed by reference)
+const int World::DEFAULT_SIZE;
+const int World::INITIAL_ROBOTS;
+const int World::DEFAULT_TILE_SIZE;
+
+World::World(int newWidth, int newHeight)
+    : width(newWidth), height(newHeight), robotCount(0), stepCount(0), counters(nullptr), battleLog(nullptr),
+      seed(static_cast<uint64_t>(time(nullptr))), random(seed), tileSize(DEFAULT_TILE_SIZE) {
+    // Initialize the grid to empty cells, all of them on the free-cell list
+    int cellCount = width * height;
+    grid.assign(cellCount, -1);
+    freeCells.resize(cellCount);
+    freeCellPositions.resize(cellCount);
+    for (int cell = 0; cell < cellCount; cell++) {
+        freeCells[cell] = cell;
+        freeCellPositions[cell] = cell;
+    }
+    occupancy.reset(width, height);
+    for (int type = 0; type < ROBOT_TYPE_COUNT; type++) {
+        spawnCredit[type] = 0;
+        nextSequence[type] = 0;
+    }
+}
+
+World::~World() {
+    // Robot facades are destroyed with their pool, and the robot store frees its own arrays
 }
 
 void World::initialize() {
-    // Seed random number generator
-    srand(static_cast<unsigned>(time(nullptr)));
-    
-    // Create 5 of each robot type and place them randomly
-    for (int i = 0; i < INITIAL_ROBOTS; i++) {
-        // Create OptimusPrime
-        auto pos = getRandomEmptyCell();
-        createOptimusPrime(pos.first, pos.second, i);
-        
-        // Create Robocop
-        pos = getRandomEmptyCell();
-        createRobocop(pos.first, pos.second, i);
-        
-        // Create Roomba
-        pos = getRandomEmptyCell();
-        createRoomba(pos.first, pos.second, i);
-        
-        // Create Bulldozer
-        pos = getRandomEmptyCell();
-        createBulldozer(pos.first, pos.second, i);
-        
-        // Create Kamikaze
-        pos = getRandomEmptyCell();
-        createKamikaze(pos.first, pos.second, i);
+    // 5 of each robot type
+    initialize(vector<int>(ROBOT_TYPE_COUNT, INITIAL_ROBOTS));
+}
+
+void World::initialize(const vector<int>& typeCounts) {
+    // Create the requested number of each robot type and place them randomly,
+    // one of each type in turn (the order in which the original 5 of each were created)
+    int mostRobots = 0;
+    for (int type = 0; type < ROBOT_TYPE_COUNT; type++) {
+        mostRobots = max(mostRobots, typeCounts[type]);
+    }
+    for (int i = 0; i < mostRobots; i++) {
+        for (int type = 0; type < ROBOT_TYPE_COUNT; type++) {
+            if (i < typeCounts[type]) {
+                auto pos = getRandomEmptyCell();
+                createRobot(static_cast<RobotType>(type), pos.first, pos.second, i);
+            }
+        }
     }
     
-    // Set the initial robot count
-    robotCount = INITIAL_ROBOTS * 5;
+    // Set the initial robot count (robots that did not fit on the grid were not created)
+    robotCount = robots.getActiveCount();
 }
 
 bool World::simulateOneStep() {
     stepCount++;
     cout << "===== Step " << stepCount << " =====" << endl;
+    if (battleLog) {
+        stepEvents.push_back(battleEvent(BATTLE_STEP, -1, -1));
+    }
     
     // Reset all move flags before processing
     resetMoveFlags();
     
     // Process each cell in the grid for movement and combat
-    for (int i = 0; i < GRID_SIZE; i++) {
-        for (int j = 0; j < GRID_SIZE; j++) {
-            // It's crucial to use the current state of grid[i][j]
+    for (int i = 0; i < width; i++) {
+        for (int j = 0; j < height; j++) {
+            // It's crucial to use the current state of the cell (i, j)
             // as it might change during the loop if robots move into this cell
             // after the original occupant moved out or died.
-            Robot* currentRobot = grid[i][j]; 
+            Robot* currentRobot = getAt(i, j); 
             
             // Skip empty cells and robots that have already moved
             if (currentRobot == nullptr || currentRobot->hasMoved()) {
@@ -87,47 +113,38 @@ bool World::simulateOneStep() {
             currentRobot->setMoved(true);
             
             // Let the robot move (handled by the Robot's move() method)
-            // This call might result in currentRobot being deleted or moved from grid[i][j]
+            // This call might result in currentRobot being deleted or moved from the cell (i, j)
             currentRobot->move(); 
             
             // DO NOT call heal() here on 'currentRobot' if it might have been deleted.
         }
     }
+    writeStepEvents();
 
     // After all robots have attempted to move and fight, apply healing
-    for (int i = 0; i < GRID_SIZE; i++) {
-        for (int j = 0; j < GRID_SIZE; j++) {
-            if (grid[i][j] != nullptr && grid[i][j]->isAlive()) {
-                // heal() method itself should check if the robot is Humanic
-                grid[i][j]->heal(); 
-            }
-        }
-    }
+    // (one pass over the robot store; only living humanic robots have a heal rate)
+    robots.healAll();
     
-    // Recalculate robot count at the end of each step
-    int actualRobotCount = 0;
-    for (int i = 0; i < GRID_SIZE; i++) {
-        for (int j = 0; j < GRID_SIZE; j++) {
-            if (grid[i][j] != nullptr && grid[i][j]->isAlive()) {
-                actualRobotCount++;
-            }
-        }
+    // Add new robots, if the world spawns any
+    int spawned = spawnRobots();
+    if (spawned > 0) {
+        cout << spawned << " new robots have spawned" << endl;
     }
-    robotCount = actualRobotCount;
+    
+    // Dead robots are removed when they die, so the store counts the living robots
+    robotCount = robots.getActiveCount();
         
-    // Check if only one robot remains
-    if (robotCount <= 1) {
+    // Check if only one robot remains (robots that keep spawning never leave a winner)
+    if (robotCount <= 1 && !spawning.isContinuous()) {
         // Find the last robot standing and announce winner
-        for (int i = 0; i < GRID_SIZE; i++) {
-            for (int j = 0; j < GRID_SIZE; j++) {
-                if (grid[i][j] != nullptr) {
-                    cout << "===== SIMULATION ENDED =====" << endl;
-                    cout << "Winner: " << grid[i][j]->getName() << " (" << grid[i][j]->getType() << ")" << endl;
-                    cout << "HP remaining: " << grid[i][j]->getHitpoints() << endl;
-                    cout << "============================" << endl;
-                    return false; // Simulation should end
-                }
-            }
+        int survivor = findSurvivor();
+        if (survivor != -1) {
+            Robot* winner = facades.get(survivor);
+            cout << "===== SIMULATION ENDED =====" << endl;
+            cout << "Winner: " << winner->getName() << " (" << winner->getType() << ")" << endl;
+            cout << "HP remaining: " << winner->getHitpoints() << endl;
+            cout << "============================" << endl;
+            return false; // Simulation should end
         }
         
         // No robots found at all
@@ -140,33 +157,678 @@ bool World::simulateOneStep() {
     return true; // Simulation should continue
 }
 
-// Reset the moved flags for all robots in the grid
-void World::resetMoveFlags() {
-    for (int i = 0; i < GRID_SIZE; i++) {
-        for (int j = 0; j < GRID_SIZE; j++) {
-            if (grid[i][j] != nullptr) {
-                grid[i][j]->setMoved(false);
+// Simulate one step on the robot store: the same rules and visiting order as simulateOneStep,
+// with no virtual calls and no output
+bool World::simulateFastStep() {
+    stepCount++;
+    if (counters) {
+        counters->steps++;
+    }
+    robots.resetMoved();
+    if (battleLog) {
+        stepEvents.push_back(battleEvent(BATTLE_STEP, -1, -1));
+    }
+    
+    // Visit the cells in the same order as simulateOneStep (who moves first decides who attacks first);
+    // a robot that moved into a cell not visited yet is skipped by its moved flag
+    // Only the occupied cells are visited: the bits of one bitmap word are read before its robots move,
+    // and a cell emptied since then is skipped by the grid
+    StepContext context = { &random, counters, 0, 0, width - 1, height - 1, nullptr, nullptr,
+                            battleLog ? &stepEvents : nullptr };
+    int columnWords = (height + 63) / 64;
+    for (int i = 0; i < width; i++) {
+        for (int word = 0; word < columnWords; word++) {
+            uint64_t bits = occupancy.getColumnWord(i, word);
+            while (bits != 0) {
+                int j = word * 64 + __builtin_ctzll(bits);
+                bits &= bits - 1;
+                int slot = grid[cellIndex(i, j)];
+                if (slot == -1 || robots.moved[slot]) {
+                    continue;
+                }
+                robots.moved[slot] = 1;
+                fastMove(slot, context);
             }
         }
     }
+    writeStepEvents();
+    
+    // Heal every living humanic robot in one pass
+    robots.healAll();
+    spawnRobots();
+    
+    // Dead robots are removed as soon as they die, so every stored robot is alive
+    robotCount = robots.getActiveCount();
+    return robotCount > 1 || spawning.isContinuous();
+}
+
+// Simulate one step with the fast step's rules, tile by tile on a thread pool
+// The tiles are coloured like a 2x2 checkerboard and the step runs in four phases,
+// one colour at a time. A robot may move at most half a tile past the edges of the
+// tile it starts in, so two tiles of the same colour never touch the same cell and
+// run in parallel without locks. Each tile draws from its own random numbers, seeded
+// from the world's seed, the step and the tile, and the effects shared by the whole
+// world (the free-cell list, freed store slots, counters) are applied after the
+// phases in tile order. The results depend only on the seed and the tile size, not
+// on the number of threads or the order in which the threads finish.
+bool World::simulateParallelStep(ThreadPool& pool) {
+    stepCount++;
+    if (counters) {
+        counters->steps++;
+    }
+    robots.resetMoved();
+    if (tiles.empty()) {
+        buildTiles();
+    }
+    if (battleLog) {
+        battleLog->write(battleEvent(BATTLE_STEP, -1, -1));
+    }
+    
+    for (int phase = 0; phase < 4; phase++) {
+        const vector<int>& phaseTileList = phaseTiles[phase];
+        pool.run(static_cast<int>(phaseTileList.size()), [this, &phaseTileList](int i) { runTile(phaseTileList[i]); });
+        
+        // The phase's fights go to the log in tile order
+        if (battleLog) {
+            for (size_t i = 0; i < phaseTileList.size(); i++) {
+                vector<BattleEvent>& events = tiles[phaseTileList[i]].events;
+                battleLog->write(events.data(), events.size());
+                events.clear();
+            }
+        }
+    }
+    
+    // Apply what the tiles left for after the step
+    for (size_t i = 0; i < tiles.size(); i++) {
+        Tile& tile = tiles[i];
+        for (size_t j = 0; j < tile.changedCells.size(); j++) {
+            syncCell(tile.changedCells[j]);
+        }
+        tile.changedCells.clear();
+        for (size_t j = 0; j < tile.deadSlots.size(); j++) {
+            destroyRobot(tile.deadSlots[j]);
+        }
+        tile.deadSlots.clear();
+        if (counters) {
+            counters->add(tile.counters);
+            tile.counters.reset();
+        }
+    }
+    
+    robots.healAll();
+    spawnRobots();
+    robotCount = robots.getActiveCount();
+    return robotCount > 1 || spawning.isContinuous();
+}
+
+void World::setTileSize(int newTileSize) {
+    tileSize = max(2, newTileSize);
+    tiles.clear();
+}
+
+void World::buildTiles() {
+    int tilesX = (width + tileSize - 1) / tileSize;
+    int tilesY = (height + tileSize - 1) / tileSize;
+    tiles.resize(tilesX * tilesY);
+    for (int phase = 0; phase < 4; phase++) {
+        phaseTiles[phase].clear();
+    }
+    for (int tx = 0; tx < tilesX; tx++) {
+        for (int ty = 0; ty < tilesY; ty++) {
+            int index = tx * tilesY + ty;
+            Tile& tile = tiles[index];
+            tile.minX = tx * tileSize;
+            tile.minY = ty * tileSize;
+            tile.maxX = min(width, tile.minX + tileSize) - 1;
+            tile.maxY = min(height, tile.minY + tileSize) - 1;
+            phaseTiles[(tx % 2) + 2 * (ty % 2)].push_back(index);
+        }
+    }
+}
+
+// Move the robots that start the step in a tile, in the fast step's order within the tile
+void World::runTile(int index) {
+    Tile& tile = tiles[index];
+    tile.random.setSeed(seed ^ (static_cast<uint64_t>(stepCount) * 0x9e3779b97f4a7c15ULL)
+                             ^ (static_cast<uint64_t>(index) * 0xc2b2ae3d27d4eb4fULL));
+    
+    // Half a tile of reach on each side: the tiles between two tiles of the same colour are a whole tile wide
+    int reach = tileSize / 2;
+    StepContext context = { &tile.random, counters ? &tile.counters : nullptr,
+                            max(0, tile.minX - reach), max(0, tile.minY - reach),
+                            min(width - 1, tile.maxX + reach), min(height - 1, tile.maxY + reach),
+                            &tile.changedCells, &tile.deadSlots, battleLog ? &tile.events : nullptr };
+    for (int i = tile.minX; i <= tile.maxX; i++) {
+        for (int j = tile.minY; j <= tile.maxY; j++) {
+            int slot = grid[cellIndex(i, j)];
+            if (slot == -1 || robots.moved[slot]) {
+                continue;
+            }
+            robots.moved[slot] = 1;
+            fastMove(slot, context);
+        }
+    }
+}
+
+// Move a robot in a random direction until it hits a wall (or the edge of the context's cells) or another robot
+// Beating the robot in the way frees its cell, and the robot keeps moving
+void World::fastMove(int slot, StepContext& context) {
+    int dx = 0, dy = 0;
+    switch (context.random->nextInt(4)) {  // 0: up, 1: right, 2: down, 3: left
+        case 0: dy = -1; break;
+        case 1: dx = 1; break;
+        case 2: dy = 1; break;
+        case 3: dx = -1; break;
+    }
+    
+    int x = robots.x[slot];
+    int y = robots.y[slot];
+    while (true) {
+        // Slide over the empty cells in one go: only the cell the robot stops in is written
+        // On the whole grid the bitmaps give the run of empty cells a word at a time; in a tile
+        // they are only brought up to date after the step, so the grid is walked instead
+        int distance = 0;
+        if (context.changedCells) {
+            int nextX = x + dx;
+            int nextY = y + dy;
+            while (nextX >= context.minX && nextX <= context.maxX && nextY >= context.minY && nextY <= context.maxY &&
+                   grid[cellIndex(nextX, nextY)] == -1) {
+                nextX += dx;
+                nextY += dy;
+                distance++;
+            }
+        } else {
+            distance = occupancy.freeRun(x, y, dx, dy);
+        }
+        int newX = x + dx * (distance + 1);
+        int newY = y + dy * (distance + 1);
+        if (distance > 0) {
+            writeCell(newX - dx, newY - dy, slot, context);
+            writeCell(x, y, -1, context);
+            x = newX - dx;
+            y = newY - dy;
+            robots.x[slot] = x;
+            robots.y[slot] = y;
+            if (context.counters) {
+                context.counters->moves += distance;
+            }
+        }
+        if (newX < context.minX || newX > context.maxX || newY < context.minY || newY > context.maxY) {
+            return;  // Can't move outside the grid (or the cells of this tile)
+        }
+        
+        // Another robot is in the way
+        int defender = grid[cellIndex(newX, newY)];
+        fastFight(slot, defender, context);
+        bool defenderAlive = robots.hitpoints[defender] > 0;
+        
+        // Dead robots leave the grid right away (a kamikaze attack can kill both)
+        if (!defenderAlive) {
+            removeDead(defender, newX, newY, context);
+        }
+        if (robots.hitpoints[slot] <= 0) {
+            removeDead(slot, x, y, context);
+            return;
+        }
+        if (defenderAlive) {
+            return;  // Both survived, no movement
+        }
+        
+        // The winner takes the defender's cell and keeps going
+        writeCell(newX, newY, slot, context);
+        writeCell(x, y, -1, context);
+        x = newX;
+        y = newY;
+        robots.x[slot] = x;
+        robots.y[slot] = y;
+        if (context.counters) {
+            context.counters->moves++;
+        }
+    }
+}
+
+void World::writeCell(int x, int y, int slot, StepContext& context) {
+    if (context.changedCells) {
+        grid[cellIndex(x, y)] = slot;
+        context.changedCells->push_back(cellIndex(x, y));
+    } else {
+        setCellSlot(x, y, slot);
+    }
+}
+
+void World::removeDead(int slot, int x, int y, StepContext& context) {
+    if (context.counters) {
+        context.counters->destroyed[robots.type[slot]]++;
+        context.counters->lifetimeSteps[robots.type[slot]] += stepCount - robots.bornStep[slot];
+    }
+    writeCell(x, y, -1, context);
+    if (context.deadSlots) {
+        context.deadSlots->push_back(slot);
+    } else {
+        destroyRobot(slot);
+    }
+}
+
+// Damage of a single attack by a robot of a type known at compile time, with the same rules
+// (and the same sequence of draws) as Robot::getDamage and its overrides
+// hitpoints is the attacking robot's (a kamikaze uses them up); rolls are noted in hit, if not nullptr
+template <int Type>
+static inline int typedDamage(Random& random, int strength, int& hitpoints, EventCounters* counters, BattleEvent* hit) {
+    if (Type == KAMIKAZE) {
+        int damage = hitpoints;  // Damage equals hitpoints, then the robot dies
+        hitpoints = 0;
+        return damage;
+    }
+    
+    int damage = random.nextInt(strength) + 1;
+    if (hit) {
+        hit->firstDamage = damage;
+    }
+    if (Type == ROOMBA) {
+        int secondDamage = random.nextInt(strength) + 1;  // Roomba attacks twice
+        if (hit) {
+            hit->secondDamage = secondDamage;
+        }
+        return damage + secondDamage;
+    }
+    if (Type == OPTIMUS_PRIME || Type == ROBOCOP) {
+        if (random.nextInt(100) < 15) {
+            damage += 40;  // Tactical nuke (humanic)
+            if (counters) {
+                counters->tacticalNukes++;
+            }
+            if (hit) {
+                hit->flags |= BATTLE_TACTICAL_NUKE;
+            }
+        }
+    }
+    if (Type == OPTIMUS_PRIME) {
+        if (random.nextInt(100) < 20) {
+            damage *= 2;   // Strong attack
+            if (counters) {
+                counters->strongAttacks++;
+            }
+            if (hit) {
+                hit->flags |= BATTLE_STRONG_ATTACK;
+            }
+        }
+    }
+    return damage;
+}
+
+// Whole fight between robots of two types known at compile time: the attacker hits first, then
+// the defender hits back, until one of them dies. Both damage functions inline into one loop
+// that keeps the hitpoints in registers. Returns the number of attacks.
+template <int AttackerType, int DefenderType>
+static int fightKernel(Random& random, int& attackerHitpoints, int& defenderHitpoints,
+                       int attackerStrength, int defenderStrength, EventCounters* counters) {
+    int attackerHp = attackerHitpoints;
+    int defenderHp = defenderHitpoints;
+    int attacks = 0;
+    while (attackerHp > 0 && defenderHp > 0) {
+        defenderHp -= typedDamage<AttackerType>(random, attackerStrength, attackerHp, counters, nullptr);
+        attacks++;
+        if (defenderHp <= 0) {
+            break;
+        }
+        
+        attackerHp -= typedDamage<DefenderType>(random, defenderStrength, defenderHp, counters, nullptr);
+        attacks++;
+    }
+    attackerHitpoints = attackerHp;
+    defenderHitpoints = defenderHp;
+    return attacks;
+}
+
+// Fight kernel of every (attacker type, defender type) pair
+typedef int (*FightKernel)(Random&, int&, int&, int, int, EventCounters*);
+static const FightKernel FIGHT_KERNELS[ROBOT_TYPE_COUNT][ROBOT_TYPE_COUNT] = {
+    { fightKernel<OPTIMUS_PRIME, OPTIMUS_PRIME>, fightKernel<OPTIMUS_PRIME, ROBOCOP>, fightKernel<OPTIMUS_PRIME, ROOMBA>,
+      fightKernel<OPTIMUS_PRIME, BULLDOZER>, fightKernel<OPTIMUS_PRIME, KAMIKAZE> },
+    { fightKernel<ROBOCOP, OPTIMUS_PRIME>, fightKernel<ROBOCOP, ROBOCOP>, fightKernel<ROBOCOP, ROOMBA>,
+      fightKernel<ROBOCOP, BULLDOZER>, fightKernel<ROBOCOP, KAMIKAZE> },
+    { fightKernel<ROOMBA, OPTIMUS_PRIME>, fightKernel<ROOMBA, ROBOCOP>, fightKernel<ROOMBA, ROOMBA>,
+      fightKernel<ROOMBA, BULLDOZER>, fightKernel<ROOMBA, KAMIKAZE> },
+    { fightKernel<BULLDOZER, OPTIMUS_PRIME>, fightKernel<BULLDOZER, ROBOCOP>, fightKernel<BULLDOZER, ROOMBA>,
+      fightKernel<BULLDOZER, BULLDOZER>, fightKernel<BULLDOZER, KAMIKAZE> },
+    { fightKernel<KAMIKAZE, OPTIMUS_PRIME>, fightKernel<KAMIKAZE, ROBOCOP>, fightKernel<KAMIKAZE, ROOMBA>,
+      fightKernel<KAMIKAZE, BULLDOZER>, fightKernel<KAMIKAZE, KAMIKAZE> }
+};
+
+// Fight until one robot dies: the attacker hits first, then the defender hits back
+// Dispatched once per fight to the kernel of the two robots' types; a logged fight
+// goes attack by attack instead, to record every hit
+void World::fastFight(int attacker, int defender, StepContext& context) {
+    int* hitpoints = robots.hitpoints.data();
+    int attacks = 0;
+    if (!context.events) {
+        attacks = FIGHT_KERNELS[robots.type[attacker]][robots.type[defender]](
+            *context.random, hitpoints[attacker], hitpoints[defender],
+            robots.strength[attacker], robots.strength[defender], context.counters);
+    } else {
+        context.events->push_back(battleEvent(BATTLE_FIGHT_BEGIN, attacker, defender));
+        while (hitpoints[attacker] > 0 && hitpoints[defender] > 0) {
+            strike(attacker, defender, context);
+            attacks++;
+            if (hitpoints[defender] <= 0) {
+                break;
+            }
+            
+            strike(defender, attacker, context);
+            attacks++;
+        }
+        context.events->push_back(battleEvent(BATTLE_FIGHT_END, attacker, defender));
+    }
+    
+    if (context.counters) {
+        context.counters->fights++;
+        context.counters->attacks += attacks;
+    }
+}
+
+// One logged attack: the hitter's damage comes off the target's hitpoints,
+// and the hit is recorded with what printHitMessage shows
+void World::strike(int hitter, int target, StepContext& context) {
+    BattleEvent hit = battleEvent(BATTLE_HIT, hitter, target);
+    hit.defenderHitpointsBefore = robots.hitpoints[target];
+    hit.damage = rollDamage(hitter, context, &hit);
+    robots.hitpoints[target] -= hit.damage;
+    hit.attackerHitpoints = robots.hitpoints[hitter];
+    hit.defenderHitpoints = robots.hitpoints[target];
+    if (hit.defenderHitpoints <= 0) {
+        hit.flags |= BATTLE_DESTROYED;
+    }
+    context.events->push_back(hit);
+}
+
+// A log record of this step about two robots (-1 for none)
+BattleEvent World::battleEvent(BattleEventKind kind, int attacker, int defender) const {
+    BattleEvent event;
+    memset(&event, 0, sizeof(event));
+    event.kind = static_cast<uint8_t>(kind);
+    event.step = stepCount;
+    if (attacker != -1) {
+        event.attackerType = static_cast<uint8_t>(robots.type[attacker]);
+        event.attacker = robots.sequence[attacker];
+    }
+    if (defender != -1) {
+        event.defenderType = static_cast<uint8_t>(robots.type[defender]);
+        event.defender = robots.sequence[defender];
+    }
+    return event;
+}
+
+void World::writeStepEvents() {
+    if (battleLog) {
+        battleLog->write(stepEvents.data(), stepEvents.size());
+        stepEvents.clear();
+    }
+}
+
+// Damage of a single attack, by robot type
+int World::rollDamage(int slot, StepContext& context, BattleEvent* hit) {
+    Random& random = *context.random;
+    int strength = robots.strength[slot];
+    int& hitpoints = robots.hitpoints[slot];
+    
+    switch (robots.type[slot]) {
+        case OPTIMUS_PRIME: return typedDamage<OPTIMUS_PRIME>(random, strength, hitpoints, context.counters, hit);
+        case ROBOCOP: return typedDamage<ROBOCOP>(random, strength, hitpoints, context.counters, hit);
+        case ROOMBA: return typedDamage<ROOMBA>(random, strength, hitpoints, context.counters, hit);
+        case KAMIKAZE: return typedDamage<KAMIKAZE>(random, strength, hitpoints, context.counters, hit);
+        default: return typedDamage<BULLDOZER>(random, strength, hitpoints, context.counters, hit);
+    }
+}
+
+void World::setSeed(uint64_t newSeed) {
+    seed = newSeed;
+    random.setSeed(seed);
+}
+
+uint64_t World::getSeed() const {
+    return seed;
+}
+
+Random& World::getRandom() {
+    return random;
+}
+
+void World::setEventCounters(EventCounters* newCounters) {
+    counters = newCounters;
+}
+
+void World::setBattleLog(BattleLogWriter* newBattleLog) {
+    writeStepEvents();
+    battleLog = newBattleLog;
+}
+
+void World::setSpawnSettings(const SpawnSettings& newSpawning) {
+    spawning = newSpawning;
+}
+
+const SpawnSettings& World::getSpawnSettings() const {
+    return spawning;
+}
+
+// Write everything needed to continue this world exactly where it is: the robot store,
+// the grid and free-cell list, the step count, the spawn state and the generator state
+bool World::saveCheckpoint(const string& path) const {
+    CheckpointHeader header;
+    memset(&header, 0, sizeof(header));
+    header.width = width;
+    header.height = height;
+    header.stepCount = stepCount;
+    header.tileSize = tileSize;
+    header.slotCount = robots.getSlotCount();
+    header.freeSlotCount = static_cast<int>(robots.getFreeSlots().size());
+    header.freeCellCount = static_cast<int>(freeCells.size());
+    header.respawn = spawning.respawn ? 1 : 0;
+    header.seed = seed;
+    random.getState(header.randomState);
+    header.waveInterval = spawning.waveInterval;
+    for (int type = 0; type < ROBOT_TYPE_COUNT; type++) {
+        header.waveSize[type] = spawning.waveSize[type];
+        header.nextSequence[type] = nextSequence[type];
+        header.spawnRate[type] = spawning.rate[type];
+        header.spawnCredit[type] = spawnCredit[type];
+    }
+    
+    const void* sections[CHECKPOINT_SECTION_COUNT] = {
+        robots.type.data(), robots.hitpoints.data(), robots.strength.data(), robots.maxHitpoints.data(),
+        robots.healRate.data(), robots.x.data(), robots.y.data(), robots.sequence.data(), robots.bornStep.data(),
+        robots.moved.data(), robots.active.data(), robots.getFreeSlots().data(), grid.data(), freeCells.data()
+    };
+    for (int section = 0; section < CHECKPOINT_SECTION_COUNT; section++) {
+        header.sectionSize[section] = header.slotCount * sizeof(int);
+    }
+    header.sectionSize[SECTION_MOVED] = header.slotCount * sizeof(uint8_t);
+    header.sectionSize[SECTION_ACTIVE] = header.slotCount * sizeof(uint8_t);
+    header.sectionSize[SECTION_FREE_SLOTS] = header.freeSlotCount * sizeof(int);
+    header.sectionSize[SECTION_GRID] = grid.size() * sizeof(int);
+    header.sectionSize[SECTION_FREE_CELLS] = header.freeCellCount * sizeof(int);
+    return Checkpoint::write(path, header, sections);
+}
+
+// Restore a world saved by saveCheckpoint (of any size), after checking that the saved
+// grid, store and lists agree with each other; the world is left as it was if they do not
+bool World::loadCheckpoint(const Checkpoint& checkpoint) {
+    if (!checkpoint.isValid()) {
+        return false;
+    }
+    const CheckpointHeader& header = checkpoint.getHeader();
+    long long cellCount = static_cast<long long>(header.width) * header.height;
+    long long slotCount = header.slotCount;
+    bool valid = header.width > 0 && header.height > 0 && cellCount <= 0x7fffffff && slotCount >= 0 &&
+                 header.freeSlotCount >= 0 && header.freeSlotCount <= slotCount &&
+                 header.freeCellCount >= 0 && header.freeCellCount <= cellCount && header.stepCount >= 0 &&
+                 header.sectionSize[SECTION_MOVED] == static_cast<uint64_t>(slotCount) &&
+                 header.sectionSize[SECTION_ACTIVE] == static_cast<uint64_t>(slotCount) &&
+                 header.sectionSize[SECTION_FREE_SLOTS] == header.freeSlotCount * sizeof(int) &&
+                 header.sectionSize[SECTION_GRID] == cellCount * sizeof(int) &&
+                 header.sectionSize[SECTION_FREE_CELLS] == header.freeCellCount * sizeof(int);
+    for (int section = SECTION_TYPE; valid && section <= SECTION_BORN_STEP; section++) {
+        valid = header.sectionSize[section] == slotCount * sizeof(int);
+    }
+    if (!valid) {
+        return false;
+    }
+    
+    const int* savedType = static_cast<const int*>(checkpoint.getSection(SECTION_TYPE));
+    const uint8_t* savedActive = static_cast<const uint8_t*>(checkpoint.getSection(SECTION_ACTIVE));
+    const int* savedFreeSlots = static_cast<const int*>(checkpoint.getSection(SECTION_FREE_SLOTS));
+    const int* savedX = static_cast<const int*>(checkpoint.getSection(SECTION_X));
+    const int* savedY = static_cast<const int*>(checkpoint.getSection(SECTION_Y));
+    const int* savedGrid = static_cast<const int*>(checkpoint.getSection(SECTION_GRID));
+    const int* savedFreeCells = static_cast<const int*>(checkpoint.getSection(SECTION_FREE_CELLS));
+    
+    // Every stored robot must be on the grid once, and every listed cell and slot must be free
+    long long activeSlots = 0;
+    for (long long slot = 0; valid && slot < slotCount; slot++) {
+        if (savedActive[slot]) {
+            activeSlots++;
+            valid = savedType[slot] >= 0 && savedType[slot] < ROBOT_TYPE_COUNT;
+        }
+    }
+    long long emptyCells = 0;
+    for (long long cell = 0; valid && cell < cellCount; cell++) {
+        int slot = savedGrid[cell];
+        if (slot == -1) {
+            emptyCells++;
+        } else {
+            valid = slot >= 0 && slot < slotCount && savedActive[slot] && savedY[slot] >= 0 && savedY[slot] < header.height &&
+                    static_cast<long long>(savedX[slot]) * header.height + savedY[slot] == cell;
+        }
+    }
+    valid = valid && emptyCells == header.freeCellCount && activeSlots == cellCount - emptyCells &&
+            header.freeSlotCount == slotCount - activeSlots;
+    
+    // The free lists must hold each empty cell and each unused slot exactly once: a repeated
+    // cell would stay listed once it is filled, and a repeated slot would be handed out twice
+    vector<uint8_t> listed(cellCount, 0);
+    for (int i = 0; valid && i < header.freeCellCount; i++) {
+        int cell = savedFreeCells[i];
+        valid = cell >= 0 && cell < cellCount && savedGrid[cell] == -1 && !listed[cell];
+        if (valid) {
+            listed[cell] = 1;
+        }
+    }
+    listed.assign(slotCount, 0);
+    for (int i = 0; valid && i < header.freeSlotCount; i++) {
+        int slot = savedFreeSlots[i];
+        valid = slot >= 0 && slot < slotCount && !savedActive[slot] && !listed[slot];
+        if (valid) {
+            listed[slot] = 1;
+        }
+    }
+    if (!valid) {
+        return false;
+    }
+    
+    // Drop the current robots, then copy every array out of the checkpoint
+    for (int slot = 0; slot < robots.getSlotCount(); slot++) {
+        if (robots.active[slot]) {
+            facades.destroy(slot);
+        }
+    }
+    robots.restore(header.slotCount, savedFreeSlots, header.freeSlotCount);
+    int* intSections[] = { robots.type.data(), robots.hitpoints.data(), robots.strength.data(), robots.maxHitpoints.data(),
+                           robots.healRate.data(), robots.x.data(), robots.y.data(), robots.sequence.data(),
+                           robots.bornStep.data() };
+    for (int section = SECTION_TYPE; section <= SECTION_BORN_STEP; section++) {
+        memcpy(intSections[section], checkpoint.getSection(static_cast<CheckpointSection>(section)), header.sectionSize[section]);
+    }
+    memcpy(robots.moved.data(), checkpoint.getSection(SECTION_MOVED), header.sectionSize[SECTION_MOVED]);
+    memcpy(robots.active.data(), savedActive, header.sectionSize[SECTION_ACTIVE]);
+    robots.recount();
+    
+    width = header.width;
+    height = header.height;
+    grid.assign(savedGrid, savedGrid + cellCount);
+    rebuildOccupancy();
+    freeCells.assign(savedFreeCells, savedFreeCells + header.freeCellCount);
+    freeCellPositions.assign(cellCount, -1);
+    for (int i = 0; i < header.freeCellCount; i++) {
+        freeCellPositions[freeCells[i]] = i;
+    }
+    for (int slot = 0; slot < robots.getSlotCount(); slot++) {
+        if (robots.active[slot]) {
+            facades.create(static_cast<RobotType>(robots.type[slot]), this, slot);
+        }
+    }
+    
+    stepCount = header.stepCount;
+    robotCount = robots.getActiveCount();
+    tileSize = max(2, static_cast<int>(header.tileSize));
+    tiles.clear();
+    seed = header.seed;
+    random.setState(header.randomState);
+    spawning = checkpoint.getSpawnSettings();
+    for (int type = 0; type < ROBOT_TYPE_COUNT; type++) {
+        spawnCredit[type] = header.spawnCredit[type];
+        nextSequence[type] = header.nextSequence[type];
+    }
+    respawnQueue.clear();
+    return true;
+}
+
+// Add the robots due at the end of a step: respawns of the robots destroyed in it,
+// then the spawn rates' share (whole robots; fractions carry over) and the wave, if one is due
+int World::spawnRobots() {
+    int spawned = 0;
+    for (size_t i = 0; i < respawnQueue.size(); i++) {
+        spawned += spawnRobot(static_cast<RobotType>(respawnQueue[i]));
+    }
+    respawnQueue.clear();
+    
+    bool waveDue = spawning.waveInterval > 0 && stepCount % spawning.waveInterval == 0;
+    for (int type = 0; type < ROBOT_TYPE_COUNT; type++) {
+        spawnCredit[type] += spawning.rate[type];
+        int count = static_cast<int>(spawnCredit[type]);
+        spawnCredit[type] -= count;
+        if (waveDue) {
+            count += spawning.waveSize[type];
+        }
+        for (int i = 0; i < count; i++) {
+            spawned += spawnRobot(static_cast<RobotType>(type));
+        }
+    }
+    return spawned;
+}
+
+bool World::spawnRobot(RobotType type) {
+    auto pos = getRandomEmptyCell();
+    if (pos.first == -1) {
+        return false;
+    }
+    
+    createRobot(type, pos.first, pos.second, nextSequence[type]);
+    if (counters) {
+        counters->spawned[type]++;
+    }
+    return true;
+}
+
+// Reset the moved flags for all robots in the grid
+void World::resetMoveFlags() {
+    robots.resetMoved();
 }
 
 // Display the current state of the grid
 void World::displayGrid() const {
     cout << "   ";
-    for (int i = 0; i < GRID_SIZE; i++) {
+    for (int i = 0; i < width; i++) {
         cout << i << " ";
     }
     cout << endl;
     
-    for (int j = 0; j < GRID_SIZE; j++) {
+    for (int j = 0; j < height; j++) {
         cout << j << "  ";
-        for (int i = 0; i < GRID_SIZE; i++) {
-            if (grid[i][j] == nullptr) {
+        for (int i = 0; i < width; i++) {
+            if (grid[cellIndex(i, j)] == -1) {
                 cout << ". ";
             } else {
                 // Display first letter of robot type
-                cout << grid[i][j]->getType()[0] << " ";
+                cout << ROBOT_TYPES[robots.type[grid[cellIndex(i, j)]]].name[0] << " ";
             }
         }
         cout << endl;
@@ -178,6 +840,16 @@ void World::displayGrid() const {
 // Handle the fight between two robots
 // This function is called when two robots encounter each other
 void World::fight(Robot* attacker, Robot* defender) {
+    if (battleLog) {
+        // Same rules and draws as the virtual getDamage calls below, recorded instead of printed
+        StepContext context = { &random, nullptr, 0, 0, width - 1, height - 1, nullptr, nullptr, &stepEvents };
+        fastFight(attacker->getSlot(), defender->getSlot(), context);
+        if (!attacker->isAlive() || !defender->isAlive()) {
+            robotCount--;
+        }
+        return;
+    }
+    
     cout << "\n=== FIGHT BEGINS ===" << endl;
     cout << attacker->getName() << " (" << attacker->getType() << ") vs. " 
          << defender->getName() << " (" << defender->getType() << ")" << endl;
@@ -226,78 +898,193 @@ void World::printHitMessage(Robot* attacker, Robot* defender, int damage, int de
 }
 // Get the robot at the specified position
 Robot* World::getAt(int x, int y) const {
-    if (isValidPosition(x, y)) {
-        return grid[x][y];
+    if (isValidPosition(x, y) && grid[cellIndex(x, y)] != -1) {
+        return facades.get(grid[cellIndex(x, y)]);
     }
     return nullptr;
 }
 // Set the robot at the specified position
 void World::setAt(int x, int y, Robot* robot) {
     if (isValidPosition(x, y)) {
-        grid[x][y] = robot;
+        setCellSlot(x, y, (robot != nullptr) ? robot->getSlot() : -1);
     }
 }
 // Remove the robot at the specified position
 void World::removeAt(int x, int y) {
-    if (isValidPosition(x, y) && grid[x][y] != nullptr) {
-        delete grid[x][y];
-        grid[x][y] = nullptr;
+    if (isValidPosition(x, y) && grid[cellIndex(x, y)] != -1) {
+        destroyRobot(grid[cellIndex(x, y)]);
+        setCellSlot(x, y, -1);
     }
 }
 
 void World::createOptimusPrime(int x, int y, int sequence) {
-    if (isValidPosition(x, y) && grid[x][y] == nullptr) {
-        grid[x][y] = new OptimusPrime(this, x, y, sequence);
-    }
+    createRobot(OPTIMUS_PRIME, x, y, sequence);
 }
 
 void World::createRobocop(int x, int y, int sequence) {
-    if (isValidPosition(x, y) && grid[x][y] == nullptr) {
-        grid[x][y] = new Robocop(this, x, y, sequence);
-    }
+    createRobot(ROBOCOP, x, y, sequence);
 }
 
 void World::createRoomba(int x, int y, int sequence) {
-    if (isValidPosition(x, y) && grid[x][y] == nullptr) {
-        grid[x][y] = new Roomba(this, x, y, sequence);
-    }
+    createRobot(ROOMBA, x, y, sequence);
 }
 
 void World::createBulldozer(int x, int y, int sequence) {
-    if (isValidPosition(x, y) && grid[x][y] == nullptr) {
-        grid[x][y] = new Bulldozer(this, x, y, sequence);
-    }
+    createRobot(BULLDOZER, x, y, sequence);
 }
 
 void World::createKamikaze(int x, int y, int sequence) {
-    if (isValidPosition(x, y) && grid[x][y] == nullptr) {
-        grid[x][y] = new Kamikaze(this, x, y, sequence);
+    createRobot(KAMIKAZE, x, y, sequence);
+}
+
+// Store a new robot and create the facade object of its type
+void World::createRobot(RobotType type, int x, int y, int sequence) {
+    if (!isValidPosition(x, y) || grid[cellIndex(x, y)] != -1) {
+        return;
+    }
+    
+    int slot = robots.add(type, x, y, sequence, stepCount);
+    facades.create(type, this, slot);
+    setCellSlot(x, y, slot);
+    nextSequence[type] = max(nextSequence[type], sequence + 1);
+}
+
+// Destroy a robot's facade and free its slot (the caller clears its grid cell)
+// With respawn on, a robot of the same type is added at the end of the step
+void World::destroyRobot(int slot) {
+    if (spawning.respawn) {
+        respawnQueue.push_back(robots.type[slot]);
     }
+    facades.destroy(slot);
+    robots.remove(slot);
+}
+
+RobotStore& World::getStore() {
+    return robots;
+}
+
+const RobotStore& World::getStore() const {
+    return robots;
 }
 
 bool World::isValidPosition(int x, int y) const {
-    return (x >= 0 && x < GRID_SIZE && y >= 0 && y < GRID_SIZE);
+    return (x >= 0 && x < width && y >= 0 && y < height);
 }
 
 bool World::isEmpty(int x, int y) const {
-    return isValidPosition(x, y) && (grid[x][y] == nullptr);
+    return isValidPosition(x, y) && (grid[cellIndex(x, y)] == -1);
 }
 // Get a random empty cell in the grid
 // This function is used for placing new robots
+// Picks from the free-cell list, so it takes the same time however full the grid is
+// Returns (-1, -1) if the grid is full
 pair<int, int> World::getRandomEmptyCell() {
-    int x, y;
-    do {
-        x = rand() % GRID_SIZE;
-        y = rand() % GRID_SIZE;
-    } while (!isEmpty(x, y));
+    if (freeCells.empty()) {
+        return make_pair(-1, -1);
+    }
     
+    int cell = freeCells[random.nextInt(static_cast<int>(freeCells.size()))];
+    return make_pair(cell / height, cell % height);
+}
+
+// Get a random empty cell in an area of the grid (corners inclusive, clipped to the grid)
+// Counts the area's empty cells with the bitmaps, so it takes about (area / 64) steps
+pair<int, int> World::getRandomEmptyCellIn(int minX, int minY, int maxX, int maxY) {
+    int x, y;
+    if (!occupancy.randomEmptyCellInRect(random, minX, minY, maxX, maxY, x, y)) {
+        return make_pair(-1, -1);
+    }
     return make_pair(x, y);
 }
 
+// Find the robot closest to a cell (counting diagonal steps as one), with the robots of
+// the types in typeMask only; a robot at the cell itself is not counted
+int World::findNearestRobot(int x, int y, unsigned typeMask, int maxDistance) const {
+    int foundX, foundY;
+    if (!isValidPosition(x, y) || !occupancy.findNearest(x, y, typeMask, maxDistance, foundX, foundY)) {
+        return -1;
+    }
+    return grid[cellIndex(foundX, foundY)];
+}
+
+const OccupancyMap& World::getOccupancy() const {
+    return occupancy;
+}
+
+// Put a robot slot (or -1 for none) in a cell, keeping the free-cell list and the bitmaps up to date
+// (the robot that was in the cell may already be destroyed: its type is still in the store)
+void World::setCellSlot(int x, int y, int slot) {
+    int cell = cellIndex(x, y);
+    if (grid[cell] != -1) {
+        occupancy.clear(x, y, robots.type[grid[cell]]);
+    }
+    if (slot != -1) {
+        occupancy.set(x, y, robots.type[slot]);
+    }
+    grid[cell] = slot;
+    syncFreeCell(cell);
+}
+
+// A cell is on the free-cell list exactly when it is empty
+void World::syncFreeCell(int cell) {
+    bool listed = (freeCellPositions[cell] != -1);
+    if (listed && grid[cell] != -1) {
+        // Remove the cell from the free list by moving the last free cell into its place
+        int position = freeCellPositions[cell];
+        int lastCell = freeCells.back();
+        freeCells[position] = lastCell;
+        freeCellPositions[lastCell] = position;
+        freeCells.pop_back();
+        freeCellPositions[cell] = -1;
+    } else if (!listed && grid[cell] == -1) {
+        freeCellPositions[cell] = static_cast<int>(freeCells.size());
+        freeCells.push_back(cell);
+    }
+}
+
+void World::syncCell(int cell) {
+    int slot = grid[cell];
+    occupancy.assign(cell / height, cell % height, slot == -1 ? -1 : robots.type[slot]);
+    syncFreeCell(cell);
+}
+
+void World::rebuildOccupancy() {
+    occupancy.reset(width, height);
+    for (int x = 0; x < width; x++) {
+        for (int y = 0; y < height; y++) {
+            int slot = grid[cellIndex(x, y)];
+            if (slot != -1) {
+                occupancy.set(x, y, robots.type[slot]);
+            }
+        }
+    }
+}
+
+int World::getWidth() const {
+    return width;
+}
+
+int World::getHeight() const {
+    return height;
+}
+
 int World::getRobotCount() const {
     return robotCount;
 }
 
+int World::getRobotCount(RobotType type) const {
+    return robots.getTypeCount(type);
+}
+
+int World::findSurvivor() const {
+    for (int slot = 0; slot < robots.getSlotCount(); slot++) {
+        if (robots.active[slot] && robots.hitpoints[slot] > 0) {
+            return slot;
+        }
+    }
+    return -1;
+}
+
 int World::getStepCount() const {
     return stepCount;
 }
@@ -305,7 +1092,7 @@ int World::getStepCount() const {
 // This function is used for robot movement
 // It returns a pair of integers representing the new position
 pair<int, int> World::getRandomAdjacentPosition(int x, int y) {
-    int direction = rand() % 4;  // 0: up, 1: right, 2: down, 3: left
+    int direction = random.nextInt(4);  // 0: up, 1: right, 2: down, 3: left
     int newX = x, newY = y;
     
     switch (direction) {
@@ -330,8 +1117,8 @@ bool World::tryMove(Robot* robot, int newX, int newY) {
     // If destination is empty, move there
     if (isEmpty(newX, newY)) {
         // Update grid
-        grid[newX][newY] = robot;
-        grid[oldX][oldY] = nullptr;
+        setCellSlot(newX, newY, robot->getSlot());
+        setCellSlot(oldX, oldY, -1);
         
         // Update robot's position
         robot->setPosition(newX, newY);
@@ -339,21 +1126,26 @@ bool World::tryMove(Robot* robot, int newX, int newY) {
     }
     // If destination has another robot, initiate fight
     else {
-        Robot* defender = grid[newX][newY];
+        Robot* defender = getAt(newX, newY);
         fight(robot, defender);
         
+        // A dead defender is removed even if the attacker died too (a kamikaze attack)
+        if (!defender->isAlive()) {
+            destroyRobot(defender->getSlot());
+            setCellSlot(newX, newY, -1);
+        }
+        
         // If attacker survived and defender died, move to new position
-        if (robot->isAlive() && !defender->isAlive()) {
-            delete defender;  // Remove the dead defender
-            grid[newX][newY] = robot;
-            grid[oldX][oldY] = nullptr;
+        if (robot->isAlive() && isEmpty(newX, newY)) {
+            setCellSlot(newX, newY, robot->getSlot());
+            setCellSlot(oldX, oldY, -1);
             robot->setPosition(newX, newY);
             return true;
         }
         // If attacker died, remove from old position
         else if (!robot->isAlive()) {
-            grid[oldX][oldY] = nullptr;
-            delete robot;
+            setCellSlot(oldX, oldY, -1);
+            destroyRobot(robot->getSlot());
             return false;
         }
         // Both survived, no movement
@@ -1,36 +1,127 @@
 #ifndef WORLD_H
 #define WORLD_H
 
+#include "RobotStore.h"
+#include "EventCounters.h"
+#include "Random.h"
+#include "RobotPool.h"
+#include "SpawnSettings.h"
+#include "ThreadPool.h"
+#include "BattleLog.h"
+#include "OccupancyMap.h"
 #include <iostream>
 #include <vector>
 #include <string>
 
-// Forward declaration for Robot class
+// Forward declarations
 class Robot;
+class Checkpoint;
 
 /**
  * World class represents the simulation grid where robots interact
- * Manages a 10x10 grid of Robot pointers and simulation logic
+ * Manages a grid of robot slots (10x10 unless given another size) and simulation logic
+ * Robot data lives in a RobotStore; Robot objects are facades over it, used by
+ * the interactive step. simulateFastStep works on the store directly.
  */
 class World {
 private:
-    static const int GRID_SIZE = 10;          // Size of the grid (10x10)
-    static const int INITIAL_ROBOTS = 5;      // Initial count of each robot type
+    static const int DEFAULT_SIZE = 10;       // Default size of the grid (10x10)
+    static const int INITIAL_ROBOTS = 5;      // Default initial count of each robot type
+    static const int DEFAULT_TILE_SIZE = 64;  // Default tile width and height of a parallel step
     
-    Robot* grid[GRID_SIZE][GRID_SIZE];        // 2D grid of Robot pointers
+    // Where the robots of a fast move may go and where its effects are recorded:
+    // the whole grid for simulateFastStep, one tile and its reach for simulateParallelStep
+    struct StepContext {
+        Random* random;                       // Random numbers of the move
+        EventCounters* counters;              // Where events are counted (nullptr: not counted)
+        int minX, minY, maxX, maxY;           // Cells a robot may move into (inclusive)
+        std::vector<int>* changedCells;       // Cells written, for the free-cell list and the occupancy bitmaps
+                                              // (nullptr: update them at once)
+        std::vector<int>* deadSlots;          // Robots destroyed, to remove from the store (nullptr: remove at once)
+        std::vector<BattleEvent>* events;     // Where fights are logged (nullptr: not logged)
+    };
+    
+    // One tile of a parallel step, with the effects it leaves for after the step
+    struct Tile {
+        int minX, minY, maxX, maxY;           // Cells of the tile (inclusive)
+        Random random;                        // Random numbers of the tile, reseeded every step
+        std::vector<int> changedCells;        // Cells written in this step
+        std::vector<int> deadSlots;           // Robots destroyed in this step
+        EventCounters counters;               // Events of this step
+        std::vector<BattleEvent> events;      // Fights of this step, for the battle log
+    };
+    
+    int width, height;                        // Size of the grid
+    std::vector<int> grid;                    // Robot slot of each cell, column by column (-1 for an empty cell)
+    std::vector<int> freeCells;               // Indices of the empty cells, in no particular order
+    std::vector<int> freeCellPositions;       // Position of each cell in freeCells (-1 if occupied)
+    OccupancyMap occupancy;                   // Occupied cells of each robot type, as bitmaps
+    RobotStore robots;                        // Data of every robot, by slot
+    RobotPool facades;                        // Robot object of each slot, built in place
     int robotCount;                           // Current number of robots alive
     int stepCount;                            // Current simulation step
+    EventCounters* counters;                  // Where simulateFastStep counts events (nullptr: not counted)
+    BattleLogWriter* battleLog;               // Where fights are logged instead of printed (nullptr: not logged)
+    std::vector<BattleEvent> stepEvents;      // Fights of the current step, written to battleLog at its end
+    uint64_t seed;                            // Seed the random numbers started from
+    Random random;                            // Random numbers for everything that happens in this world
+    SpawnSettings spawning;                   // How robots are added during the simulation
+    double spawnCredit[ROBOT_TYPE_COUNT];     // Fractions of robots owed by the spawn rates, by type
+    int nextSequence[ROBOT_TYPE_COUNT];       // Name number of the next robot of each type
+    std::vector<int> respawnQueue;            // Types of the robots destroyed in this step, to respawn
+    int tileSize;                             // Tile width and height of a parallel step
+    std::vector<Tile> tiles;                  // Tiles of a parallel step (built by the first one)
+    std::vector<int> phaseTiles[4];           // Tiles of each checkerboard colour, in tile order
+    
+    // Data-oriented step helpers (no virtual calls, no output)
+    void fastMove(int slot, StepContext& context); // Move a robot until it is blocked, fighting what it runs into
+    void fastFight(int attacker, int defender, StepContext& context); // Fight until one of the two robots dies
+    void strike(int hitter, int target, StepContext& context); // One attack in a logged fight
+    int rollDamage(int slot, StepContext& context, BattleEvent* hit); // Damage of a single attack, by robot type
+                                              // (its rolls are noted in hit, if not nullptr)
+    BattleEvent battleEvent(BattleEventKind kind, int attacker, int defender) const; // Log record about two robots
+    void writeStepEvents();                   // Pass the step's logged fights to battleLog
+    void writeCell(int x, int y, int slot, StepContext& context); // Set a cell's robot slot during a fast move
+    void removeDead(int slot, int x, int y, StepContext& context); // Count a dead robot and take it off the grid
+    
+    // Parallel step helpers
+    void buildTiles();                        // Split the grid into tiles and sort them by colour
+    void runTile(int index);                  // Move the robots that start the step in a tile
+    
+    // Spawning helpers
+    int spawnRobots();                        // Add this step's respawns, rate spawns and wave; returns the number added
+    bool spawnRobot(RobotType type);          // Add a robot on a random empty cell (false if the grid is full)
+    
+    // Grid storage helpers
+    int cellIndex(int x, int y) const { return x * height + y; } // Index of a cell in grid
+    void setCellSlot(int x, int y, int slot); // Set a cell's robot slot and update the free-cell list and bitmaps
+    void syncFreeCell(int cell);              // Add a cell to the free-cell list or take it off, to match the grid
+    void syncCell(int cell);                  // Bring the free-cell list and the bitmaps of a cell written directly up to date
+    void rebuildOccupancy();                  // Fill the occupancy bitmaps from the grid
 
 public:
     // Constructor and destructor
-    World();
+    World(int newWidth = DEFAULT_SIZE, int newHeight = DEFAULT_SIZE);
     ~World();
     
     // Core simulation functions
-    void initialize();                       // Set up initial robots
+    void initialize();                       // Set up initial robots (5 of each type)
+    void initialize(const std::vector<int>& typeCounts); // Set up the given number of robots of each type (indexed by RobotType)
     bool simulateOneStep();                  // Simulate one time step, return false if simulation ends
     void resetMoveFlags();                   // Reset moved flags before each step
     void displayGrid() const;                // Display the current state of the grid
+    bool simulateFastStep();                 // Simulate one step on the robot store without any output
+    bool simulateParallelStep(ThreadPool& pool); // Simulate one step on the robot store, tile by tile on a thread pool
+    void setTileSize(int newTileSize);       // Tile width and height of parallel steps (at least 2)
+    bool saveCheckpoint(const std::string& path) const; // Write the whole state of the world to a file (between steps)
+    bool loadCheckpoint(const Checkpoint& checkpoint);  // Replace the whole state with a checkpoint's (false if it is not consistent)
+    void setEventCounters(EventCounters* newCounters); // Count the events of fast steps (nullptr to stop counting)
+    void setBattleLog(BattleLogWriter* newBattleLog); // Log every fight to a file instead of printing it (nullptr to stop)
+    void setSeed(uint64_t newSeed);          // Restart the world's random numbers from a seed (default: the current time)
+    uint64_t getSeed() const;                // Seed to pass to setSeed to replay this world
+    Random& getRandom();                     // Random numbers for the world's robots
+    void setSpawnSettings(const SpawnSettings& newSpawning); // Keep adding robots during the simulation
+    const SpawnSettings& getSpawnSettings() const;
     
     // Combat functions
     void fight(Robot* attacker, Robot* defender);  // Handle fight between two robots
@@ -48,11 +139,25 @@ public:
     void createBulldozer(int x, int y, int sequence);
     void createKamikaze(int x, int y, int sequence);
     
+    // Robot storage
+    RobotStore& getStore();                  // Data of every robot
+    const RobotStore& getStore() const;
+    void createRobot(RobotType type, int x, int y, int sequence); // Store a robot and create its facade
+    void destroyRobot(int slot);             // Destroy a robot's facade and free its slot
+    
     // Utility functions
     bool isValidPosition(int x, int y) const;
     bool isEmpty(int x, int y) const;
     std::pair<int, int> getRandomEmptyCell();
+    std::pair<int, int> getRandomEmptyCellIn(int minX, int minY, int maxX, int maxY); // (-1, -1) if the area is full
+    int findNearestRobot(int x, int y, unsigned typeMask, int maxDistance) const; // Slot of the closest robot of a type
+                                             // in typeMask (bit t for RobotType t) within maxDistance, or -1
+    const OccupancyMap& getOccupancy() const; // Occupied cells of each robot type
+    int getWidth() const;
+    int getHeight() const;
     int getRobotCount() const;
+    int getRobotCount(RobotType type) const; // Robots of one type alive
+    int findSurvivor() const;                // Slot of a remaining robot (the winner once one is left), or -1
     int getStepCount() const;
     
     // Random position generators (for movement)
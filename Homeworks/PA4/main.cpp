@@ -1,30 +1,357 @@
 #include "World.h"
 #include "Robot.h"
+#include "BatchRunner.h"
+#include "Checkpoint.h"
 #include <iostream>
-#include <cstdlib> // for rand()
+#include <cstdlib> // for atoi()
 #include <ctime>   // for time()
+#include <chrono>  // for steady_clock
+#include <cstring> // for strcmp()
 #include <string>
+#include <vector>
+#include <algorithm> // for max()
+#include <memory>    // for unique_ptr
 
 using namespace std;
 
-int main() {
+// Read one value for every robot type: either a single value for all types,
+// or ROBOT_TYPE_COUNT comma-separated values in RobotType order
+bool parseTypeValues(const char* text, double values[]) {
+    char* end;
+    for (int type = 0; type < ROBOT_TYPE_COUNT; type++) {
+        values[type] = strtod(text, &end);
+        if (end == text || values[type] < 0) {
+            return false;
+        }
+        if (*end == '\0') {
+            // A single value applies to every type
+            if (type == 0) {
+                for (int other = 1; other < ROBOT_TYPE_COUNT; other++) {
+                    values[other] = values[0];
+                }
+                return true;
+            }
+            return type == ROBOT_TYPE_COUNT - 1;
+        }
+        if (*end != ',') {
+            return false;
+        }
+        text = end + 1;
+    }
+    return false;
+}
+
+/**
+ * Settings of a --headless run, from the command line
+ */
+struct HeadlessOptions {
+    int width, height;          // World size (ignored when resuming)
+    int robotsPerType;          // Initial robots of each type (ignored when resuming)
+    long long maxSteps;         // Steps to run (0: until one robot is left)
+    uint64_t seed;              // Seed of a new world
+    bool reseed;                // Whether a resumed world is given seed instead of continuing its own random numbers
+    bool showCounters;          // Whether to print the event counters
+    SpawnSettings spawning;     // How robots are added during the run
+    int parallelThreads;        // Threads of parallel steps (0: serial fast steps, -1: one per core)
+    int tileSize;               // Tile size of parallel steps (0: default)
+    const Checkpoint* start;    // Checkpoint to resume from (nullptr: a new world)
+    const char* savePath;       // Where to write a checkpoint at the end (nullptr: nowhere)
+    BattleLogWriter* battleLog; // Where to log every fight (nullptr: not logged)
+};
+
+// Run a simulation with no console output until one robot is left (or maxSteps steps, if not 0),
+// then report the result and the simulation speed
+int runHeadless(const HeadlessOptions& options) {
+    World world(options.width, options.height);
+    if (options.start != nullptr) {
+        if (!world.loadCheckpoint(*options.start)) {
+            cout << "The checkpoint does not hold a consistent world" << endl;
+            return 1;
+        }
+        if (options.reseed) {
+            world.setSeed(options.seed);  // A what-if branch of the saved run
+        }
+    } else {
+        world.setSeed(options.seed);
+    }
+    world.setSpawnSettings(options.spawning);
+    if (options.tileSize > 0) {
+        world.setTileSize(options.tileSize);
+    }
+    if (options.start == nullptr) {
+        world.initialize(vector<int>(ROBOT_TYPE_COUNT, options.robotsPerType));
+    }
+    if (options.spawning.isContinuous() && options.maxSteps <= 0) {
+        cout << "Spawn rates and waves need a --steps limit with --headless" << endl;
+        return 1;
+    }
+    ThreadPool pool(options.parallelThreads == 0 ? 1 : max(options.parallelThreads, 0));  // No worker threads unless parallel
+    
+    EventCounters counters;
+    if (options.showCounters) {
+        world.setEventCounters(&counters);
+    }
+    world.setBattleLog(options.battleLog);
+    
+    auto start = chrono::steady_clock::now();
+    long long steps = 0;
+    long long firstStep = world.getStepCount();
+    bool running = world.getRobotCount() > 1 || options.spawning.isContinuous();
+    while (running && (options.maxSteps == 0 || steps < options.maxSteps)) {
+        running = (options.parallelThreads != 0) ? world.simulateParallelStep(pool) : world.simulateFastStep();
+        steps++;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    // Report
+    cout << "World: " << world.getWidth() << "x" << world.getHeight();
+    if (options.start != nullptr) {
+        cout << ", resumed at step " << firstStep << "\n";
+    } else {
+        cout << ", " << options.robotsPerType << " robots of each type" << "\n";
+    }
+    cout << "Seed: " << world.getSeed() << "\n";
+    if (options.parallelThreads != 0) {
+        cout << "Parallel steps: " << pool.getThreadCount() << " threads" << "\n";
+    }
+    cout << "Steps: " << steps << "\n";
+    int survivor = world.findSurvivor();
+    if (world.getRobotCount() == 1 && survivor != -1) {
+        const RobotStore& store = world.getStore();
+        cout << "Winner: " << ROBOT_TYPES[store.type[survivor]].name << "_" << store.sequence[survivor]
+             << " (HP remaining: " << store.hitpoints[survivor] << ")" << "\n";
+    } else if (world.getRobotCount() == 0) {
+        cout << "No robots remain! It's a draw." << "\n";
+    } else {
+        cout << "Remaining robots: " << world.getRobotCount() << " (";
+        for (int type = 0; type < ROBOT_TYPE_COUNT; type++) {
+            cout << (type > 0 ? ", " : "") << world.getRobotCount(static_cast<RobotType>(type))
+                 << " " << ROBOT_TYPES[type].name;
+        }
+        cout << ")" << "\n";
+    }
+    cout << "Time: " << seconds << " s (" << (seconds > 0 ? steps / seconds : 0) << " steps/s)" << "\n";
+    if (options.showCounters) {
+        counters.print(cout);
+    }
+    world.setBattleLog(nullptr);
+    if (options.battleLog != nullptr) {
+        cout << "Battle log: " << options.battleLog->getRecordCount() << " records" << "\n";
+    }
+    
+    if (options.savePath != nullptr) {
+        if (!world.saveCheckpoint(options.savePath)) {
+            cout << "Could not write the checkpoint " << options.savePath << endl;
+            return 1;
+        }
+        cout << "Checkpoint: " << options.savePath << " (step " << world.getStepCount() << ")" << "\n";
+    }
+    return 0;
+}
+
+// Print the command line options
+void printUsage(const char* program) {
+    cout << "Usage: " << program << " [--headless [--parallel [--tile N]] | --batch N] [--threads T] [--steps N] [--size W H] [--robots N] [--seed S] [--stats]" << endl;
+    cout << "       [--spawn-rate R] [--waves I N] [--respawn] [--load FILE] [--save FILE] [--log FILE]" << endl;
+    cout << "  Without --headless or --batch the simulation runs step by step on the console, and only" << endl;
+    cout << "  --size, --robots, --seed, the spawn options and --log apply" << endl;
+    cout << "  --headless   run without output until one robot is left, then report" << endl;
+    cout << "  --batch N    run N headless simulations on all cores and summarize them" << endl;
+    cout << "  --parallel   run each --headless step tile by tile on --threads threads (same results for any T)" << endl;
+    cout << "  --tile N     tile width and height for --parallel (default: 64)" << endl;
+    cout << "  --threads T  threads for --batch and --parallel (default: one per core)" << endl;
+    cout << "  --steps N    stop after N steps (default: no limit, or 100000 for --batch)" << endl;
+    cout << "  --size W H   world width and height (default: 10 10)" << endl;
+    cout << "  --robots N   robots of each type (default: 5)" << endl;
+    cout << "  --seed S     seed of the random numbers, to replay a simulation (default: the current time)" << endl;
+    cout << "  --stats      also print event counters (totals over the batch for --batch)" << endl;
+    cout << "  --spawn-rate R  add R robots of each type per step (fractions add up over the steps)" << endl;
+    cout << "  --waves I N  add N robots of each type every I steps" << endl;
+    cout << "  --respawn    replace every destroyed robot with a new one of its type" << endl;
+    cout << "  R and N are one number for all types, or one per type separated by commas" << endl;
+    cout << "  (optimusprime,robocop,roomba,bulldozer,kamikaze); with rates or waves the" << endl;
+    cout << "  simulation runs until the --steps limit" << endl;
+    cout << "  --save FILE  write a checkpoint of the --headless world when the run stops" << endl;
+    cout << "  --load FILE  continue from a checkpoint (--headless) or branch every --batch game from it;" << endl;
+    cout << "               the saved spawn settings are kept unless spawn options are given, and a" << endl;
+    cout << "               resumed --headless world keeps its random numbers unless --seed is given" << endl;
+    cout << "  --log FILE   write every fight to a binary battle log instead of the console" << endl;
+    cout << "               (interactive and --headless; print it with robot_log FILE)" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    // Command line options (without any, the interactive simulation runs)
+    bool headless = false;
+    bool parallel = false;
+    int tileSize = 0;
+    bool showCounters = false;
+    long long maxSteps = -1;
+    long long batchGames = 0;
+    int threads = 0;
+    uint64_t seed = static_cast<uint64_t>(time(nullptr));
+    bool seedGiven = false;
+    int width = 10, height = 10, robotsPerType = 5;
+    SpawnSettings spawning;
+    double waveSizes[ROBOT_TYPE_COUNT];
+    bool validSpawning = true;
+    bool spawningGiven = false;
+    const char* loadPath = nullptr;
+    const char* savePath = nullptr;
+    const char* logPath = nullptr;
+    bool runOptionGiven = false;  // Whether an option of --headless or --batch runs only was given
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (strcmp(argv[i], "--parallel") == 0) {
+            parallel = true;
+            runOptionGiven = true;
+        } else if (strcmp(argv[i], "--tile") == 0 && i + 1 < argc) {
+            tileSize = atoi(argv[++i]);
+            runOptionGiven = true;
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batchGames = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+            runOptionGiven = true;
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], nullptr, 10);
+            seedGiven = true;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            showCounters = true;
+            runOptionGiven = true;
+        } else if (strcmp(argv[i], "--steps") == 0 && i + 1 < argc) {
+            maxSteps = atoll(argv[++i]);
+            runOptionGiven = true;
+        } else if (strcmp(argv[i], "--size") == 0 && i + 2 < argc) {
+            width = atoi(argv[++i]);
+            height = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--robots") == 0 && i + 1 < argc) {
+            robotsPerType = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--spawn-rate") == 0 && i + 1 < argc) {
+            validSpawning = validSpawning && parseTypeValues(argv[++i], spawning.rate);
+            spawningGiven = true;
+        } else if (strcmp(argv[i], "--waves") == 0 && i + 2 < argc) {
+            spawning.waveInterval = atoi(argv[++i]);
+            validSpawning = validSpawning && spawning.waveInterval > 0 && parseTypeValues(argv[++i], waveSizes);
+            for (int type = 0; type < ROBOT_TYPE_COUNT; type++) {
+                spawning.waveSize[type] = static_cast<int>(waveSizes[type]);
+            }
+            spawningGiven = true;
+        } else if (strcmp(argv[i], "--respawn") == 0) {
+            spawning.respawn = true;
+            spawningGiven = true;
+        } else if (strcmp(argv[i], "--load") == 0 && i + 1 < argc) {
+            loadPath = argv[++i];
+            runOptionGiven = true;
+        } else if (strcmp(argv[i], "--save") == 0 && i + 1 < argc) {
+            savePath = argv[++i];
+            runOptionGiven = true;
+        } else if (strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
+            logPath = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    // The interactive simulation takes the world, spawn, seed and log options only
+    if (width <= 0 || height <= 0 || robotsPerType < 0 || batchGames < 0 || threads < 0 || maxSteps < -1 || tileSize < 0 ||
+        !validSpawning || (runOptionGiven && !headless && batchGames == 0)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    
+    // The checkpoint to start from stays mapped for the whole run
+    unique_ptr<Checkpoint> start;
+    if (loadPath != nullptr) {
+        start.reset(new Checkpoint(loadPath));
+        if (!start->isValid()) {
+            cout << "Could not read the checkpoint " << loadPath << endl;
+            return 1;
+        }
+        if (!spawningGiven) {
+            spawning = start->getSpawnSettings();
+        }
+    }
+    
+    BattleLogWriter battleLog;
+    if (logPath != nullptr && !battleLog.open(logPath)) {
+        cout << "Could not create the battle log " << logPath << endl;
+        return 1;
+    }
+    
+    if (batchGames > 0) {
+        // Every game loads the checkpoint, so check it once up front
+        World probe;
+        if (start && !probe.loadCheckpoint(*start)) {
+            cout << "The checkpoint does not hold a consistent world" << endl;
+            return 1;
+        }
+        
+        BatchSettings settings;
+        settings.width = width;
+        settings.height = height;
+        settings.robotsPerType = robotsPerType;
+        settings.games = batchGames;
+        settings.threads = threads;
+        settings.seed = seed;
+        settings.spawning = spawning;
+        settings.start = start.get();
+        if (maxSteps >= 0) {
+            settings.maxSteps = maxSteps;
+        }
+        
+        BatchSummary summary = BatchRunner(settings).run();
+        summary.print(cout);
+        if (showCounters) {
+            summary.counters.print(cout);
+        }
+        return 0;
+    }
+    
+    if (headless) {
+        HeadlessOptions options;
+        options.width = width;
+        options.height = height;
+        options.robotsPerType = robotsPerType;
+        options.maxSteps = max(maxSteps, 0LL);
+        options.seed = seed;
+        options.reseed = seedGiven;
+        options.showCounters = showCounters;
+        options.spawning = spawning;
+        options.parallelThreads = parallel ? (threads > 0 ? threads : -1) : 0;
+        options.tileSize = tileSize;
+        options.start = start.get();
+        options.savePath = savePath;
+        options.battleLog = (logPath != nullptr) ? &battleLog : nullptr;
+        int result = runHeadless(options);
+        if (!battleLog.close()) {
+            cout << "Could not write the battle log " << logPath << endl;
+            return 1;
+        }
+        return result;
+    }
+    
     cout << "=======================================" << endl;
     cout << "       ROBOT BATTLE SIMULATION         " << endl;
     cout << "=======================================" << endl;
-    cout << "5 of each robot type will be created:" << endl;
+    cout << robotsPerType << " of each robot type will be created on a " << width << "x" << height << " grid:" << endl;
     cout << "- OptimusPrime (HP:100, STR:100)" << endl;
     cout << "- Robocop (HP:40, STR:30)" << endl;
     cout << "- Roomba (HP:10, STR:3)" << endl;
     cout << "- Bulldozer (HP:200, STR:50)" << endl;
     cout << "- Kamikaze (HP:10, STR:10)" << endl;
     cout << "=======================================" << endl;
-    
-    // Seed random number generator
-    srand(static_cast<unsigned>(time(nullptr)));
+    cout << "Seed: " << seed << " (run with --seed " << seed << " to replay)" << endl;
     
     // Create and initialize world
-    World world;
-    world.initialize();
+    World world(width, height);
+    world.setSeed(seed);
+    world.setSpawnSettings(spawning);
+    world.initialize(vector<int>(ROBOT_TYPE_COUNT, robotsPerType));
+    if (logPath != nullptr) {
+        world.setBattleLog(&battleLog);
+        cout << "Fights are logged to " << logPath << " (print them with robot_log " << logPath << ")" << endl;
+    }
     
     // Display initial grid state
     cout << "\nInitial grid state:" << endl;
@@ -36,10 +363,8 @@ int main() {
     // Simulation loop
     while (continueSimulation) {
         cout << "\nPress Enter to simulate one step (or type 'q' to quit): ";
-        getline(cin, input);
-        
-        // Check if user wants to quit
-        if (input == "q" || input == "Q") {
+        // Check if user wants to quit (or input has ended, which a spawning world would never do)
+        if (!getline(cin, input) || input == "q" || input == "Q") {
             cout << "Simulation terminated by user." << endl;
             break;
         }
@@ -54,6 +379,10 @@ int main() {
     }
     
     cout << "\nSimulation ended after " << world.getStepCount() << " steps." << endl;
+    if (logPath != nullptr && !battleLog.close()) {
+        cout << "Could not write the battle log " << logPath << endl;
+        return 1;
+    }
     
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,203 @@
+#include "World.h"
+#include <atomic>
+#include <chrono>  // for steady_clock
+#include <cstdlib> // for strtod(), malloc()
+#include <cstring> // for strcmp(), strncmp()
+#include <fstream>
+#include <iomanip> // for setw()
+#include <iostream>
+#include <new>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+// Every allocation of the process goes through these, so a run can count its allocations
+static atomic<long long> allocationCount(0);
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    void* memory = malloc(size == 0 ? 1 : size);
+    if (memory == nullptr) {
+        throw bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
+
+/**
+ * Settings of the benchmark, from the command line
+ */
+struct BenchOptions {
+    vector<double> sizes;       // World widths (and heights) to run
+    vector<double> densities;   // Fractions of the cells holding a robot at the start
+    long long maxSteps;         // Steps of each run, at most
+    double maxSeconds;          // Time of each run, at most (the run stops at whichever limit comes first)
+    uint64_t seed;              // Seed of every world
+    int parallelThreads;        // Threads of parallel steps (0: serial fast steps, -1: one per core)
+    int tileSize;               // Tile size of parallel steps (0: default)
+};
+
+// Read a comma-separated list of positive numbers
+bool parseList(const char* text, vector<double>& values) {
+    values.clear();
+    char* end;
+    while (true) {
+        double value = strtod(text, &end);
+        if (end == text || value <= 0) {
+            return false;
+        }
+        values.push_back(value);
+        if (*end == '\0') {
+            return true;
+        }
+        if (*end != ',') {
+            return false;
+        }
+        text = end + 1;
+    }
+}
+
+// Largest resident set of this process so far, in kilobytes
+// The kernel's VmHWM belongs to the process's own memory, so a forked child starts from its own small
+// size (ru_maxrss, the fallback where /proc is missing, may carry over the peak of an earlier child)
+long long peakResidentKilobytes() {
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (strncmp(line.c_str(), "VmHWM:", 6) == 0) {
+            return atoll(line.c_str() + 6);
+        }
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);  // ru_maxrss is in kilobytes on Linux
+    return usage.ru_maxrss;
+}
+
+// Run one world size and density, and print one line of results
+// Destroyed robots are respawned, so the density stays about the same for the whole run
+void runBenchmark(const BenchOptions& options, int size, double density) {
+    long long cellCount = static_cast<long long>(size) * size;
+    int robotsPerType = max(1, static_cast<int>(cellCount * density / ROBOT_TYPE_COUNT));
+    World world(size, size);
+    world.setSeed(options.seed);
+    SpawnSettings spawning;
+    spawning.respawn = true;
+    world.setSpawnSettings(spawning);
+    if (options.tileSize > 0) {
+        world.setTileSize(options.tileSize);
+    }
+    world.initialize(vector<int>(ROBOT_TYPE_COUNT, robotsPerType));
+    ThreadPool pool(options.parallelThreads == 0 ? 1 : max(options.parallelThreads, 0));
+    EventCounters counters;
+    world.setEventCounters(&counters);
+
+    // Only the steps are measured, not building the world
+    long long allocationsBefore = allocationCount.load();
+    auto start = chrono::steady_clock::now();
+    double seconds = 0;
+    long long steps = 0;
+    bool running = true;
+    while (running && steps < options.maxSteps && seconds < options.maxSeconds) {
+        running = (options.parallelThreads != 0) ? world.simulateParallelStep(pool) : world.simulateFastStep();
+        steps++;
+        seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+    long long allocations = allocationCount.load() - allocationsBefore;
+
+    cout << fixed << setprecision(0)
+         << setw(11) << (to_string(size) + "x" + to_string(size))
+         << setw(9) << setprecision(3) << density
+         << setw(10) << robotsPerType * ROBOT_TYPE_COUNT
+         << setw(8) << steps
+         << setw(12) << setprecision(1) << (seconds > 0 ? steps / seconds : 0)
+         << setw(14) << setprecision(0) << (seconds > 0 ? counters.fights / seconds : 0)
+         << setw(13) << setprecision(2) << (steps > 0 ? static_cast<double>(allocations) / steps : 0)
+         << setw(14) << setprecision(1) << peakResidentKilobytes() / 1024.0
+         << endl;
+}
+
+// Print the command line options
+void printUsage(const char* program) {
+    cout << "Usage: " << program << " [--sizes N,N,...] [--densities D,D,...] [--steps N] [--seconds S] [--seed S]" << endl;
+    cout << "       [--parallel T] [--tile N]" << endl;
+    cout << "  --sizes      world widths and heights (default: 10,100,500,1000,2000)" << endl;
+    cout << "  --densities  fractions of the cells holding a robot (default: 0.01,0.1,0.5)" << endl;
+    cout << "  --steps N    steps of each run, at most (default: 1000)" << endl;
+    cout << "  --seconds S  time of each run, at most (default: 1)" << endl;
+    cout << "  --seed S     seed of every world (default: 1)" << endl;
+    cout << "  --parallel T run parallel steps on T threads (0: one per core; default: serial fast steps)" << endl;
+    cout << "  --tile N     tile width and height for --parallel (default: 64)" << endl;
+    cout << "  Every size and density runs in its own process, so the peak RSS is that run's;" << endl;
+    cout << "  destroyed robots respawn to keep the density, and allocations count only the steps" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    options.sizes = { 10, 100, 500, 1000, 2000 };
+    options.densities = { 0.01, 0.1, 0.5 };
+    options.maxSteps = 1000;
+    options.maxSeconds = 1;
+    options.seed = 1;
+    options.parallelThreads = 0;
+    options.tileSize = 0;
+    bool valid = true;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+            valid = valid && parseList(argv[++i], options.sizes);
+        } else if (strcmp(argv[i], "--densities") == 0 && i + 1 < argc) {
+            valid = valid && parseList(argv[++i], options.densities);
+        } else if (strcmp(argv[i], "--steps") == 0 && i + 1 < argc) {
+            options.maxSteps = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            options.maxSeconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--parallel") == 0 && i + 1 < argc) {
+            options.parallelThreads = atoi(argv[++i]);
+            if (options.parallelThreads == 0) {
+                options.parallelThreads = -1;  // One per core
+            }
+        } else if (strcmp(argv[i], "--tile") == 0 && i + 1 < argc) {
+            options.tileSize = atoi(argv[++i]);
+        } else {
+            valid = false;
+        }
+    }
+    for (size_t i = 0; i < options.densities.size(); i++) {
+        valid = valid && options.densities[i] <= 1;
+    }
+    if (!valid || options.maxSteps <= 0 || options.maxSeconds <= 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    cout << (options.parallelThreads != 0 ? "Parallel steps" : "Serial fast steps") << ", seed " << options.seed << endl;
+    cout << setw(11) << "size" << setw(9) << "density" << setw(10) << "robots" << setw(8) << "steps"
+         << setw(12) << "steps/s" << setw(14) << "fights/s" << setw(13) << "allocs/step" << setw(14) << "peak RSS MB" << endl;
+    for (size_t i = 0; i < options.sizes.size(); i++) {
+        for (size_t j = 0; j < options.densities.size(); j++) {
+            // A child process per run, so each run's peak RSS starts from nothing
+            pid_t child = fork();
+            if (child == 0) {
+                runBenchmark(options, static_cast<int>(options.sizes[i]), options.densities[j]);
+                _exit(0);
+            }
+            int status;
+            if (child == -1 || waitpid(child, &status, 0) != child || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                cout << "Run " << options.sizes[i] << "x" << options.sizes[i] << " at " << options.densities[j] << " failed" << endl;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
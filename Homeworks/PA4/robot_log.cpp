@@ -0,0 +1,34 @@
+#include "BattleLog.h"
+#include <cstdlib> // for atoi()
+#include <iostream>
+
+using namespace std;
+
+// Print a battle log written by robot_sim --log as the text the interactive simulation prints,
+// optionally only the steps from FIRST to LAST
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 4) {
+        cout << "Usage: " << argv[0] << " FILE [FIRST_STEP [LAST_STEP]]" << endl;
+        return 1;
+    }
+    long long firstStep = (argc > 2) ? atoll(argv[2]) : 0;
+    long long lastStep = (argc > 3) ? atoll(argv[3]) : -1;
+
+    BattleLogReader reader;
+    if (!reader.open(argv[1])) {
+        cout << "Not a battle log: " << argv[1] << endl;
+        return 1;
+    }
+
+    BattleEvent event;
+    while (reader.read(event)) {
+        if (event.step < firstStep) {
+            continue;
+        }
+        if (lastStep >= 0 && event.step > lastStep) {
+            break;
+        }
+        renderBattleEvent(event, cout);
+    }
+    return 0;
+}
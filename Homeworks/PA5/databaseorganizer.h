@@ -7,6 +7,7 @@
 #include <algorithm> // For standard algorithms like sorting
 #include "field.h" // Include the field header
 #include "entry.h" // Include the entry header
+#include "fieldindex.h" // Include the field index header
 using namespace std; // Use the standard namespace
 
 // Class definition for the database organizer
@@ -18,6 +19,8 @@ public:
     vector<pair<string, string>> catalog_exceptions; // Vector to store exceptions during catalog parsing
     vector<string> catalog_lines; // Vector to store catalog lines
     vector<string> command_log; // Vector to store the command log
+    vector<fieldindex> field_indexes; // Search index of each field, built when the data is parsed
+    vector<string> entry_lines; // String representation of each entry, built when the data is parsed
 
     // Method to parse data from a file
     void parsedata(const string& datafile);
@@ -33,12 +36,20 @@ private:
     bool parseentry(const string& line, entry& e);
     // Method to format the names of the fields
     string format_names();
+    // Method to build the search indexes and the entry strings
+    void build_indexes();
     // Method to find the index of a field
     int field_index(const string& name);
     // Method to handle the search command
     void handle_search(const string& line, vector<string>& output);
     // Method to handle the sort command
     void handle_sort(const string& line, vector<string>& output);
+    // Method to get the entry positions in the order of a field holding values of type T
+    template<class T>
+    vector<int> sorted_rows(int idx) const;
+    // Method to get the entry positions in the order of their keys (each key is paired with its position)
+    template<class K>
+    static vector<int> key_order(vector<pair<K, int>>& keys);
 };
 
 // --- Implementation ---
@@ -77,6 +88,7 @@ inline void databaseorganizer::parsedata(const string& datafile) {
     ostringstream oss; // Create a string stream
     oss << entries.size() << " unique entries"; // Add the number of unique entries to the stream
     catalog_lines.push_back(oss.str()); // Add the string to the catalog lines
+    build_indexes(); // Index the entries for the commands
 }
 
 // Implementation of the parsecommands method
@@ -207,6 +219,22 @@ inline string databaseorganizer::format_names() {
     return s; // Return the formatted names
 }
 
+// Implementation of the build_indexes method
+// Each field is converted to a string once here, so searches do no string formatting
+inline void databaseorganizer::build_indexes() {
+    field_indexes.assign(entry_format.size(), fieldindex()); // One index per field
+    entry_lines.clear(); // Clear previous entry strings
+    entry_lines.reserve(entries.size()); // One string per entry
+    for (size_t row = 0; row < entries.size(); ++row) { // Iterate over each entry
+        const entry& e = entries[row]; // Get the entry
+        for (size_t i = 0; i < e.fields.size(); ++i) // Iterate over each field
+            field_indexes[i].add(e.fields[i]->tostring(), row); // Add the field's string to the field's index
+        entry_lines.push_back(e.tostring(entry_format)); // Add the entry's string
+    }
+    for (size_t i = 0; i < field_indexes.size(); ++i) // Iterate over each field index
+        if (entry_format[i].type != dataT::B) field_indexes[i].build_grams(); // Boolean fields are only matched exactly
+}
+
 // Implementation of the field_index method
 inline int databaseorganizer::field_index(const string& name) {
     for (size_t i = 0; i < entry_format.size(); ++i) // Iterate over each field format
@@ -237,29 +265,25 @@ inline void databaseorganizer::handle_search(const string& line, vector<string>&
         return; 
     }
     
-    for (const auto& e : entries) { // Iterate over each entry
-        auto& f = e.fields[idx]; // Get the field
-        
-        // Special case for boolean fields
-        if (entry_format[idx].type == dataT::B) { // If the field is boolean
-            string field_val = f->tostring(); // Get the field value as string
-            bool is_match = false; // Flag to indicate if there's a match
-            
-            // For boolean fields, compare with both string formats
-            if ((value == "true" && (field_val == "true" || field_val == "1")) ||
-                (value == "false" && (field_val == "false" || field_val == "0"))) {
-                is_match = true; // There's a match
-            }
-            
-            if (is_match) {
-                output.push_back(e.tostring(entry_format)); // Add the entry to the output
-            }
-        }
-        // For non-boolean fields, use the default string comparison
-        else if (f->tostring().find(value) != string::npos) { // If the value is found in the field
-            output.push_back(e.tostring(entry_format)); // Add the entry to the output
+    const fieldindex& index = field_indexes[idx]; // Get the field's index
+    vector<int> matches; // Rows that match, in order
+    
+    // Special case for boolean fields
+    if (entry_format[idx].type == dataT::B) { // If the field is boolean
+        // For boolean fields, compare with both string formats
+        if (value == "true" || value == "false") { // Other values match nothing
+            vector<int> named = index.exact_rows(value); // Rows stored as "true" or "false"
+            vector<int> numbered = index.exact_rows(value == "true" ? "1" : "0"); // Rows stored as "1" or "0"
+            merge(named.begin(), named.end(), numbered.begin(), numbered.end(), back_inserter(matches)); // Both, in order
         }
     }
+    // For non-boolean fields, find the value in the field's string
+    else {
+        matches = index.find_rows(value); // Rows whose field contains the value
+    }
+    
+    for (int row : matches) // Iterate over each matching entry
+        output.push_back(entry_lines[row]); // Add the entry to the output
 }
 
 // Implementation of the handle_sort method
@@ -277,17 +301,60 @@ inline void databaseorganizer::handle_sort(const string& line, vector<string>& o
         return; 
     }
 
-    auto cmp = [this, idx](const entry& e1, const entry& e2) { // Define a lambda for comparison
-        auto& ff = entry_format[idx]; // Get the field format
-        if (ff.sm == fieldT::single) { // If the field is single
-            return e1.fields[idx]->tostring() < e2.fields[idx]->tostring(); // Compare the fields
-        } else { // If the field is multi
-            return e1.fields[idx]->tostring() < e2.fields[idx]->tostring(); // Compare the fields
-        }
-    };
+    vector<int> order; // Entry positions in sorted order
+    if (entry_format[idx].type == dataT::S) order = sorted_rows<string>(idx); // Sort by string
+    else if (entry_format[idx].type == dataT::I) order = sorted_rows<int>(idx); // Sort by integer
+    else if (entry_format[idx].type == dataT::D) order = sorted_rows<double>(idx); // Sort by double
+    else order = sorted_rows<bool>(idx); // Sort by boolean (false first)
+    
+    for (int row : order) // Iterate over the entries in sorted order
+        output.push_back(entry_lines[row]); // Add the entry to the output
+}
+
+// Implementation of the sorted_rows method
+// The key of each entry is read once from the field's data, then positions are sorted instead of
+// entries; a multi field sorts by its values in turn, except a multi string field, which sorts by
+// its ':'-joined text as it always has. Equal keys keep the order of the entries.
+template<class T>
+inline vector<int> databaseorganizer::sorted_rows(int idx) const {
+    vector<int> order(entries.size()); // Entry positions
     
-    vector<entry> sorted = entries; // Create a copy of the entries
-    sort(sorted.begin(), sorted.end(), cmp); // Sort the entries
-    for (const auto& e : sorted) // Iterate over the sorted entries
-        output.push_back(e.tostring(entry_format)); // Add the entry to the output
+    if (entry_format[idx].sm == fieldT::single) { // If the field is single
+        vector<pair<T, int>> keys; // Value and position of each entry (the position breaks ties)
+        keys.reserve(entries.size()); // One pair per entry
+        for (size_t row = 0; row < entries.size(); ++row) // Iterate over each entry
+            keys.push_back({ static_cast<const FieldSingle<T>&>(*entries[row].fields[idx]).getdata(), static_cast<int>(row) }); // Get its value
+        order = key_order(keys); // Sort by value, then position
+    } else if (entry_format[idx].type == dataT::S) { // If the field is multi string
+        // Compared as joined text, "a b:c" comes before "a:b" (' ' < ':'), unlike value by value
+        vector<pair<string, int>> keys; // Text and position of each entry
+        keys.reserve(entries.size()); // One pair per entry
+        for (size_t row = 0; row < entries.size(); ++row) // Iterate over each entry
+            keys.push_back({ entries[row].fields[idx]->tostring(), static_cast<int>(row) }); // Get its joined text
+        order = key_order(keys); // Sort by text, then position
+    } else { // If the field is multi
+        for (size_t row = 0; row < order.size(); ++row) order[row] = row; // Start in entry order
+        vector<T> values; // Values of every entry, one entry after the other
+        vector<int> starts(1, 0); // Where the values of each entry start (and the last one ends)
+        for (const auto& e : entries) { // Iterate over each entry
+            const auto& f = static_cast<const FieldMulti<T>&>(*e.fields[idx]); // Get the field
+            for (int i = 0; i < f.getsize(); ++i) values.push_back(f.getdata(i)); // Copy each value
+            starts.push_back(values.size()); // Mark the end of the entry's values
+        }
+        auto cmp = [&values, &starts](int a, int b) { // Compare the values of two entries in turn
+            return lexicographical_compare(values.begin() + starts[a], values.begin() + starts[a + 1],
+                                           values.begin() + starts[b], values.begin() + starts[b + 1]);
+        };
+        stable_sort(order.begin(), order.end(), cmp); // Sort by values
+    }
+    return order; // Return the sorted positions
+}
+
+// Implementation of the key_order method
+template<class K>
+inline vector<int> databaseorganizer::key_order(vector<pair<K, int>>& keys) {
+    sort(keys.begin(), keys.end()); // Sort by key, then position
+    vector<int> order(keys.size()); // Entry positions
+    for (size_t i = 0; i < keys.size(); ++i) order[i] = keys[i].second; // Keep the positions
+    return order; // Return the sorted positions
 }
\ No newline at end of file
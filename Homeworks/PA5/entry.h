@@ -2,6 +2,7 @@
 #include <vector> // For dynamic arrays
 #include <string> // For string manipulation
 #include <sstream> // For string stream operations
+#include <memory> // For shared_ptr
 #include "field.h" // Include the field header
 using namespace std; // Use the standard namespace
 
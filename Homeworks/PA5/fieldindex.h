@@ -0,0 +1,118 @@
+#pragma once // Include guard to prevent multiple inclusions
+#include <vector> // For dynamic arrays
+#include <string> // For string manipulation
+#include <unordered_map> // For hash tables
+#include <algorithm> // For sorting and set intersection
+using namespace std; // Use the standard namespace
+
+// Class definition for the search index of one field
+// Every distinct text of the field (what tostring() gives) is kept once, with the rows holding it,
+// in a hash table. The texts are also split into trigrams (pieces of 3 characters), so a substring
+// search only checks the texts that hold every trigram of the searched value.
+class fieldindex {
+public:
+    // Method to add the text of a field of a row (rows must be added in order)
+    void add(const string& text, int row);
+    // Method to build the trigram table once every row is added
+    void build_grams();
+    // Method to get the rows whose text contains a value, in row order
+    vector<int> find_rows(const string& value) const;
+    // Method to get the rows whose text is exactly a value, in row order
+    vector<int> exact_rows(const string& value) const;
+
+private:
+    static const size_t GRAM = 3; // Length of the pieces the texts are split into
+
+    vector<string> values; // Distinct texts of the field
+    vector<vector<int>> rows; // Rows of each distinct text, in row order
+    unordered_map<string, int> value_ids; // Position of each distinct text in values
+    unordered_map<string, vector<int>> grams; // Texts holding each trigram, in order (texts shorter than a trigram are their own key)
+
+    // Method to add a text to the list of a trigram
+    void add_gram(const string& gram, int id);
+    // Method to get the rows of some distinct texts, in row order
+    vector<int> rows_of(const vector<int>& ids) const;
+};
+
+// --- Implementation ---
+
+// Implementation of the add method
+inline void fieldindex::add(const string& text, int row) {
+    auto found = value_ids.find(text); // Look the text up
+    if (found == value_ids.end()) { // If it is a new text
+        found = value_ids.insert({ text, static_cast<int>(values.size()) }).first; // Give it the next position
+        values.push_back(text); // Store the text
+        rows.push_back(vector<int>()); // With no rows yet
+    }
+    rows[found->second].push_back(row); // Add the row to the text's rows
+}
+
+// Implementation of the build_grams method
+inline void fieldindex::build_grams() {
+    grams.clear(); // Clear previous trigrams
+    for (size_t id = 0; id < values.size(); ++id) { // Iterate over each distinct text
+        const string& text = values[id]; // Get the text
+        if (text.size() < GRAM) { // If the text is too short to have a trigram
+            add_gram(text, id); // The whole text is the key
+            continue;
+        }
+        for (size_t i = 0; i + GRAM <= text.size(); ++i) // Iterate over each trigram of the text
+            add_gram(text.substr(i, GRAM), id); // Add the text to the trigram's list
+    }
+}
+
+// Implementation of the add_gram method
+inline void fieldindex::add_gram(const string& gram, int id) {
+    vector<int>& ids = grams[gram]; // Get the trigram's list
+    if (ids.empty() || ids.back() != id) ids.push_back(id); // Add the text once, even if the trigram repeats
+}
+
+// Implementation of the find_rows method
+inline vector<int> fieldindex::find_rows(const string& value) const {
+    vector<int> candidates; // Distinct texts that may contain the value
+    if (value.size() < GRAM) { // If the value is shorter than a trigram
+        // Every text containing it has a trigram (or is a short text) containing it
+        for (const auto& g : grams) { // Iterate over each trigram
+            if (g.first.find(value) != string::npos) // If the trigram contains the value
+                candidates.insert(candidates.end(), g.second.begin(), g.second.end()); // Add its texts
+        }
+        sort(candidates.begin(), candidates.end()); // Sort the texts
+        candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end()); // Remove duplicates
+    } else {
+        // The texts holding every trigram of the value, starting with the shortest list
+        vector<const vector<int>*> lists; // List of each trigram of the value
+        for (size_t i = 0; i + GRAM <= value.size(); ++i) { // Iterate over each trigram of the value
+            auto found = grams.find(value.substr(i, GRAM)); // Look the trigram up
+            if (found == grams.end()) return vector<int>(); // No text holds it: no match
+            lists.push_back(&found->second); // Add its list
+        }
+        sort(lists.begin(), lists.end(), [](const vector<int>* a, const vector<int>* b) { return a->size() < b->size(); }); // Shortest list first
+        candidates = *lists[0]; // Start with the shortest list
+        for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) { // Intersect with each other list
+            vector<int> common; // Texts in both
+            set_intersection(candidates.begin(), candidates.end(), lists[i]->begin(), lists[i]->end(), back_inserter(common));
+            candidates.swap(common); // Keep the common texts
+        }
+    }
+
+    vector<int> ids; // Texts that contain the value
+    for (int id : candidates) // Iterate over each candidate text
+        if (values[id].find(value) != string::npos) ids.push_back(id); // Keep it if the value is really in it
+    return rows_of(ids); // Return the rows of these texts
+}
+
+// Implementation of the exact_rows method
+inline vector<int> fieldindex::exact_rows(const string& value) const {
+    auto found = value_ids.find(value); // Look the text up
+    if (found == value_ids.end()) return vector<int>(); // No row has this text
+    return rows[found->second]; // Return its rows
+}
+
+// Implementation of the rows_of method
+inline vector<int> fieldindex::rows_of(const vector<int>& ids) const {
+    vector<int> result; // Rows of the texts
+    for (int id : ids) // Iterate over each text
+        result.insert(result.end(), rows[id].begin(), rows[id].end()); // Add its rows
+    sort(result.begin(), result.end()); // Put the rows back in order
+    return result; // Return the rows
+}